@@ -48,17 +48,56 @@
 #include "cycfg.h"
 #include "cycfg_capsense.h"
 #include "user_led_control.h"
+#include "user_profiler.h"
+#include "user_telemetry.h"
+#include "user_energy.h"
+#include "user_snapshot.h"
+#include "user_marker.h"
+#include "user_report.h"
 
 /*******************************************************************************
 * User configurable Macros
 ********************************************************************************/
+/* The feature and timing macros guarded with #ifndef are set per build variant
+* through CONFIG_VARIANT in the Makefile */
+
 /* Enable this, if Tuner needs to be enabled */
+#ifndef ENABLE_TUNER
 #define ENABLE_TUNER                     (1u)
+#endif
+
+/* Enable this, to run the Tuner only on the main loop passes after the host
+* accessed the Tuner buffer, and at least every TUNER_SERVICE_DIVIDER passes,
+* instead of on every pass */
+#ifndef ENABLE_TUNER_ON_DEMAND
+#define ENABLE_TUNER_ON_DEMAND           (1u)
+#endif
+#define TUNER_SERVICE_DIVIDER            (128u)
 
 /* Enable this, if Serial LED needs to be enabled */
+#ifndef ENABLE_SPI_SERIAL_LED
 #define ENABLE_SPI_SERIAL_LED            (1u)
+#endif
 #define SERIAL_LED_BRIGHTNESS_MAX       (255u)
 
+/* Enable this, to show the LED1 status as a bar over all the NUM_OF_LEDS
+* serial LEDs, the bar length follows the proximity distance */
+#ifndef ENABLE_LED_BAR_GRAPH
+#define ENABLE_LED_BAR_GRAPH             (0u)
+#endif
+
+/* Enable this, to fade LED1 to each new status color over LED_FADE_FRAMES
+* ACTIVE mode frames, instead of switching it at once */
+#ifndef ENABLE_LED_ANIMATION
+#define ENABLE_LED_ANIMATION             (0u)
+#endif
+#define LED_FADE_FRAMES                  (16u)
+
+/* LED animation time of a WOT mode frame in ACTIVE mode frames, about the WOT
+* timeout of the CAPSENSE configuration. The fades shorter than this complete
+* when the device moves to WOT mode instead of freezing half way */
+#define WOT_MODE_ANIMATION_FRAMES        (ACTIVE_MODE_REFRESH_RATE)
+
 /* 128Hz Refresh rate in Active mode */
 #define ACTIVE_MODE_REFRESH_RATE         (128u)
 
@@ -72,16 +111,46 @@
 #define ALR_MODE_TIMEOUT_SEC             (5u)
 
 /* Scan time in microseconds */
+#ifndef ACTIVE_MODE_FRAME_SCAN_TIME
 #define ACTIVE_MODE_FRAME_SCAN_TIME     (2891u)
-
-/* Active mode Processing time in us ~= 23us with Serial LED and Tuner disabled*/
-#define ACTIVE_MODE_PROCESS_TIME        (23u)
+#endif
 
 /* Scan time in microseconds */
+#ifndef ALR_MODE_FRAME_SCAN_TIME
 #define ALR_MODE_FRAME_SCAN_TIME        (2891u)
+#endif
+
+/* Processing time in us ~= 23us with Serial LED and Tuner disabled, measured
+* with CONFIG_VARIANT=bench */
+#ifndef WIDGET_PROCESS_TIME
+#define WIDGET_PROCESS_TIME             (23u)
+#endif
+
+/* Processing time budget in us added by the LED frame update and by a Tuner
+* pass without host access. Estimates, not measured: replace them with the
+* times measured on the target, e.g. ledBenchmarkMaxCycles / TICKS_PER_US
+* for the LED frame encoding, before relying on the budget check below */
+#ifndef SERIAL_LED_PROCESS_TIME
+#define SERIAL_LED_PROCESS_TIME         (40u)
+#endif
+#ifndef TUNER_PROCESS_TIME
+#define TUNER_PROCESS_TIME              (100u)
+#endif
+
+/* Active mode Processing time in us with the enabled features */
+#ifndef ACTIVE_MODE_PROCESS_TIME
+#define ACTIVE_MODE_PROCESS_TIME        (WIDGET_PROCESS_TIME + \
+                                        (ENABLE_SPI_SERIAL_LED * SERIAL_LED_PROCESS_TIME) + \
+                                        (ENABLE_TUNER * TUNER_PROCESS_TIME))
+#endif
 
-/* ALR mode Processing time in us ~= 23us with Serial LED and Tuner disabled*/
-#define ALR_MODE_PROCESS_TIME           (23u)
+/* ALR mode Processing time in us with the enabled features */
+#ifndef ALR_MODE_PROCESS_TIME
+#define ALR_MODE_PROCESS_TIME           (ACTIVE_MODE_PROCESS_TIME)
+#endif
+
+/* Fraction bits of the proximity LED brightness scale factor */
+#define PROX_BRIGHTNESS_SCALE_SHIFT     (16u)
 
 /* Touch status of the proximity sensor */
 #define TOUCH_STATE                     (3u)
@@ -89,9 +158,222 @@
 /* Proximity status of the proximity sensor */
 #define PROX_STATE                      (1u)
 
+/* Enable this, to move the refresh rate in ACTIVE mode between
+* ACTIVE_MODE_REFRESH_RATE and ALR_MODE_REFRESH_RATE based on the proximity
+* diff trend: highest rate while the diff rises (target approaching) and a
+* gradual decay to the lower rate levels afterwards */
+#ifndef ENABLE_ADAPTIVE_REFRESH_RATE
+#define ENABLE_ADAPTIVE_REFRESH_RATE     (0u)
+#endif
+
+/* Intermediate refresh rate levels of the adaptive refresh rate in Hz */
+#define ADAPTIVE_REFRESH_RATE_LEVEL_1    (96u)
+#define ADAPTIVE_REFRESH_RATE_LEVEL_2    (64u)
+#define ADAPTIVE_REFRESH_RATE_LEVEL_3    (48u)
+
+/* Rise of the proximity diff count in one frame that indicates an approaching target */
+#define ADAPTIVE_REFRESH_APPROACH_DIFF   (16u)
+
+/* Number of frames without approach after which the refresh rate moves one level down */
+#define ADAPTIVE_REFRESH_DECAY_FRAMES    (64u)
+
+/* Enable this, to arm the scan of the next frame as soon as the raw counts of
+* the current frame are captured. Processing, LED and Tuner work of the current
+* frame then run while the MSCLP timer of the next frame is counting, so the
+* processing time does not add to the frame period. A refresh rate change takes
+* effect one frame later, as the next frame is armed before the mode decision.
+* A frame whose processing outlasts the MSCLP timer, e.g. by the wait for the
+* previous LED frame, is discarded and counted in pipelinedFrameDiscardCount.
+* The Tuner is not supported, its communication time is not bounded */
+#ifndef ENABLE_PIPELINED_SCAN
+#define ENABLE_PIPELINED_SCAN            (0u)
+#endif
+
 /* Enable run time measurements for various modes of the application, 
 * this run time is used to calculate MSCLP timer reload value */
+#ifndef ENABLE_RUN_TIME_MEASUREMENT
 #define ENABLE_RUN_TIME_MEASUREMENT      (0u)
+#endif
+
+/* Enable this, to benchmark the LED frame encoder at startup, e.g. with
+* CONFIG_VARIANT=bench: LED_BENCHMARK_FRAMES fixed LED patterns are encoded,
+* each frame is checked against a bit by bit reference encoder and the cycles
+* are stored in ledBenchmark*. Needs ENABLE_RUN_TIME_MEASUREMENT and
+* SERIAL_LED_TX_FULL */
+#ifndef ENABLE_LED_BENCHMARK
+#define ENABLE_LED_BENCHMARK             (ENABLE_RUN_TIME_MEASUREMENT && \
+                                         (SERIAL_LED_TX_MODE == SERIAL_LED_TX_FULL))
+#endif
+#define LED_BENCHMARK_FRAMES             (16u)
+
+/* Enable this, to measure the scan and process time at startup and every
+* TIMER_CALIBRATION_INTERVAL frames, and to compute the MSCLP timer of each
+* refresh rate from the longest of the last TIMER_CALIBRATION_WINDOW measured
+* times instead of the *_FRAME_SCAN_TIME and *_PROCESS_TIME constants. The
+* measured frame waits in CPU Sleep instead of Deep Sleep, as SysTick does not
+* run in Deep Sleep, so DEEP_SLEEP_WAKEUP_US is added for the other frames */
+#ifndef ENABLE_TIMER_CALIBRATION
+#define ENABLE_TIMER_CALIBRATION         (1u)
+#endif
+#define TIMER_CALIBRATION_INTERVAL       (160u)
+#define TIMER_CALIBRATION_WINDOW         (8u)
+#ifndef DEEP_SLEEP_WAKEUP_US
+#define DEEP_SLEEP_WAKEUP_US             (35u)
+#endif
+
+/* Enable this, to show the low power widget detection of the WOT frame on the
+* LEDs and to the host right away, and to start the scan of the first ACTIVE
+* mode frame without waiting for the MSCLP timer period */
+#ifndef ENABLE_WOT_FAST_WAKE
+#define ENABLE_WOT_FAST_WAKE             (1u)
+#endif
+
+/* LED1 (GREEN) brightness on the low power widget detection, shown until the
+* proximity sensor of the first ACTIVE mode frame is processed */
+#define WOT_WAKE_LED_BRIGHTNESS          (SERIAL_LED_BRIGHTNESS_MAX / 8u)
+
+/* Enable this, to confirm the ALR mode activity over several frames, to use
+* separate proximity diff thresholds to move up from ALR mode and to stay in
+* ACTIVE mode, and to keep each state for a minimum number of frames. This
+* avoids the ACTIVE/ALR mode oscillation in noisy environments. Disabled by
+* default, the thresholds below are to be tuned on the hardware */
+#ifndef ENABLE_TRANSITION_HYSTERESIS
+#define ENABLE_TRANSITION_HYSTERESIS     (0u)
+#endif
+
+/* ALR mode moves to ACTIVE mode when ALR_MODE_ACTIVITY_CONFIRM of the last
+* TRANSITION_WINDOW_FRAMES frames are active, up to 32 frames */
+#define TRANSITION_WINDOW_FRAMES         (4u)
+#define ALR_MODE_ACTIVITY_CONFIRM        (2u)
+
+/* Proximity diff count that an ALR mode frame needs to be active: the
+* proximity threshold (proxTh) of Proximity0 plus TRANSITION_UP_HYSTERESIS
+* times its hysteresis. An ACTIVE mode frame without widget activity is idle
+* below proxTh minus TRANSITION_DOWN_HYSTERESIS times the hysteresis. Both
+* follow the thresholds set at run time, e.g. by the Tuner */
+#define TRANSITION_UP_HYSTERESIS         (2u)
+#define TRANSITION_DOWN_HYSTERESIS       (2u)
+
+/* Proximity threshold, touch threshold and hysteresis of Proximity0 as tuned
+* in design.cycapsense, for the build time check of the transition
+* thresholds. main() asserts that the widget configuration matches them */
+#define PROXIMITY0_PROX_TH               (96u)
+#define PROXIMITY0_TOUCH_TH              (2970u)
+#define PROXIMITY0_HYSTERESIS            (12u)
+
+/* Minimum number of frames spent in each state before it is left */
+#define ACTIVE_MODE_MIN_DWELL            (0u)
+#define ALR_MODE_MIN_DWELL               (4u)
+#define WOT_MODE_MIN_DWELL               (0u)
+
+/* Enable this, to re-arm the WOT scan directly after WOT_DIRECT_REARM_CYCLES
+* consecutive WOT timeouts without activity, instead of scanning ALR_MODE_TIMEOUT
+* frames in ALR mode after every WOT timeout. A burst of
+* WOT_BASELINE_REFRESH_FRAMES baseline refresh frames is then scanned every
+* WOT_BASELINE_REFRESH_CYCLES WOT cycles. The baselines are tracked less often
+* than in ALR mode, so this is disabled by default */
+#ifndef ENABLE_WOT_DIRECT_REARM
+#define ENABLE_WOT_DIRECT_REARM          (0u)
+#endif
+#define WOT_DIRECT_REARM_CYCLES          (3u)
+#define WOT_BASELINE_REFRESH_CYCLES      (6u)
+
+/* Frames of the baseline refresh burst. The first WOT_BASELINE_FILTER_FRAMES
+* frames refill the Proximity0 raw count median (3) and average (4) filter
+* history of design.cycapsense, so their activity is ignored. The baseline IIR
+* filter then tracks the drift in WOT_BASELINE_IIR_FRAMES frames, 1 s in total
+* at the ALR mode refresh rate */
+#define WOT_BASELINE_FILTER_FRAMES       (3u + 4u)
+#define WOT_BASELINE_IIR_FRAMES          (25u)
+#define WOT_BASELINE_REFRESH_FRAMES      (WOT_BASELINE_FILTER_FRAMES + WOT_BASELINE_IIR_FRAMES)
+
+/* Enable this, to scan and process only the proximity widget in ALR mode
+* (sentinel frames). The full widget set is scanned and processed after an
+* active frame and every ALR_SENTINEL_FULL_FRAME_DIVIDER ALR frames, which
+* maintains the baselines of the other widgets. Disabled by default: in this
+* design Proximity0 is the only widget of the regular slots, so a sentinel
+* frame scans the same slots as a full frame. Measure the ALR mode scan and
+* process time (CONFIG_VARIANT=bench) before enabling it in a design with
+* more widgets */
+#ifndef ENABLE_ALR_SENTINEL
+#define ENABLE_ALR_SENTINEL              (0u)
+#endif
+#define ALR_SENTINEL_FULL_FRAME_DIVIDER  (16u)
+
+/* Enable this, to monitor the noise of the proximity sensor and to scan it
+* with fewer sub-conversions in quiet conditions. The noise is the variance of
+* the raw count change from frame to frame, over the ACTIVE and ALR mode frames
+* with a diff below the noise threshold. The conditions switch only after
+* NOISE_SWITCH_IDLE_FRAMES such frames in a row, and only Proximity0 is then
+* recalibrated and its baseline reinitialized. In quiet
+* conditions Proximity0 is scanned with the configured sub-conversions divided
+* by 2^NOISE_QUIET_SUBCONV_SHIFT, and its thresholds are divided likewise as
+* the signal scales with the sub-conversions. In noisy conditions the
+* configuration of design.cycapsense is restored, every ALR frame is a full
+* frame and ALR mode needs NOISY_ALR_MODE_ACTIVITY_CONFIRM active frames to
+* move to ACTIVE mode. The filters of the CAPSENSE configuration are selected
+* at build time and are the same in both conditions. Disabled by default, the
+* quiet configuration is to be tuned on the hardware */
+#ifndef ENABLE_NOISE_MONITOR
+#define ENABLE_NOISE_MONITOR             (0u)
+#endif
+#define NOISE_QUIET_SUBCONV_SHIFT        (1u)
+
+/* The conditions are noisy above a raw count deviation of noiseTh of
+* Proximity0, and quiet again below noiseTh / 2. The variance of the raw count
+* change from frame to frame is twice the raw count variance */
+#define NOISE_HIGH_VARIANCE(noiseTh)     (2u * (uint32_t)(noiseTh) * (noiseTh))
+#define NOISE_LOW_VARIANCE(noiseTh)      (2u * ((uint32_t)(noiseTh) / 2u) * ((noiseTh) / 2u))
+
+/* The noise variance is averaged over about 2^NOISE_FILTER_SHIFT idle frames */
+#define NOISE_FILTER_SHIFT               (4u)
+
+/* Consecutive frames with a diff below the noise threshold before the
+* conditions switch, so Proximity0 is never recalibrated with a target near */
+#define NOISE_SWITCH_IDLE_FRAMES         (2u << NOISE_FILTER_SHIFT)
+
+/* ALR mode activity confirmation in noisy conditions, of the last
+* TRANSITION_WINDOW_FRAMES frames */
+#define NOISY_ALR_MODE_ACTIVITY_CONFIRM  (3u)
+
+/* Enable this, to double the WOT scan interval after every
+* WOT_INTERVAL_STEP_CYCLES consecutive WOT timeouts without activity, up to
+* WOT_INTERVAL_LEVEL_NUM - 1 times, and to restore it on user activity. The
+* number of frames in WOT is halved with every step, so the WOT timeout and the
+* baseline refresh rate stay the same. A longer interval delays the wake up from
+* WOT mode, so this is disabled by default */
+#ifndef ENABLE_WOT_AUTO_INTERVAL
+#define ENABLE_WOT_AUTO_INTERVAL         (0u)
+#endif
+#define WOT_INTERVAL_STEP_CYCLES         (6u)
+#define WOT_INTERVAL_LEVEL_NUM           (3u)
+
+/* Worst case wake up latency allowed from WOT mode, in us. The interval is not
+* doubled beyond it, so set it from the product requirement. The default allows
+* one doubling of the configured 62.5 ms WOT scan interval */
+#ifndef WOT_SCAN_INTERVAL_MAX_US
+#define WOT_SCAN_INTERVAL_MAX_US         (125000u)
+#endif
+
+/* Enable this, to detect the ACTIVE and ALR mode frames stretched beyond the
+* refresh rate period by the processing, LED and Tuner work. The time from the
+* scan complete interrupt to the next scan start is compared against the
+* refresh rate period minus the MSCLP timer and the scan time, at least the
+* estimated ACTIVE_MODE_PROCESS_TIME with the LED and Tuner work, plus
+* OVERRUN_TOLERANCE_US. The overruns and the worst lateness are counted in
+* frameOverrunCount and frameMaxLateness. The pipelined scan arms the next
+* scan right after the scan complete, so it is not supported */
+#ifndef ENABLE_OVERRUN_MONITOR
+#define ENABLE_OVERRUN_MONITOR           (1u)
+#endif
+#define OVERRUN_TOLERANCE_US             (100u)
+
+/* Enable this, to skip the LED and Tuner work of the frame after an overrun,
+* at most every other frame. Permanent overruns halve the LED and Tuner update
+* rate, so this is disabled by default */
+#ifndef ENABLE_OVERRUN_DEGRADE
+#define ENABLE_OVERRUN_DEGRADE           (0u)
+#endif
 
 /*******************************************************************************
 * Macros
@@ -102,35 +384,149 @@
 
 #define EZI2C_INTR_PRIORITY              (2u)
 
+/* Events posted by the interrupts to the main loop. APP_EVENT_SCAN_DONE is
+* cleared when a scan is started, the host events when they are handled */
+#define APP_EVENT_SCAN_DONE              (0x01u) /* MSCLP scan complete */
+#define APP_EVENT_HOST_ACCESS            (0x02u) /* Host read or wrote the Tuner buffer */
+#define APP_EVENT_HOST_READ              (0x04u) /* Host read the host interface */
+
 #define ILO_FREQ                        (40000u)
 #define TIME_IN_US                      (1000000u)
 
 #define MINIMUM_TIMER                   (TIME_IN_US / ILO_FREQ)
 
-/* 128Hz Refresh rate in Active mode */
-#if ((TIME_IN_US / ACTIVE_MODE_REFRESH_RATE) > (ACTIVE_MODE_FRAME_SCAN_TIME + ACTIVE_MODE_PROCESS_TIME))
+#if (ENABLE_OVERRUN_DEGRADE && !ENABLE_OVERRUN_MONITOR)
+    #error "ENABLE_OVERRUN_DEGRADE needs ENABLE_OVERRUN_MONITOR"
+#endif
+
+#if (ENABLE_OVERRUN_MONITOR && ENABLE_PIPELINED_SCAN)
+    #error "ENABLE_OVERRUN_MONITOR does not support ENABLE_PIPELINED_SCAN, the next scan starts at the scan complete"
+#endif
+
+#if (ENABLE_TUNER && ENABLE_PIPELINED_SCAN)
+    #error "ENABLE_TUNER does not support ENABLE_PIPELINED_SCAN, the Tuner communication may outlast the MSCLP timer"
+#endif
+
+#if (ENABLE_BASELINE_SNAPSHOT && !ENABLE_WOT_DIRECT_REARM)
+    #error "ENABLE_BASELINE_SNAPSHOT needs ENABLE_WOT_DIRECT_REARM, the snapshot is saved in BASELINE_MODE"
+#endif
+
+#if (ENABLE_WOT_AUTO_INTERVAL && (WOT_INTERVAL_LEVEL_NUM < 1u))
+    #error "WOT_INTERVAL_LEVEL_NUM must be at least 1"
+#endif
+
+/* Time of a frame not covered by the MSCLP timer */
+#if ENABLE_PIPELINED_SCAN
+    /* Processing overlaps the MSCLP timer of the next frame */
+    #define ACTIVE_MODE_FRAME_BUSY_TIME (ACTIVE_MODE_FRAME_SCAN_TIME)
+    #define ALR_MODE_FRAME_BUSY_TIME    (ALR_MODE_FRAME_SCAN_TIME)
+#else
+    #define ACTIVE_MODE_FRAME_BUSY_TIME (ACTIVE_MODE_FRAME_SCAN_TIME + ACTIVE_MODE_PROCESS_TIME)
+    #define ALR_MODE_FRAME_BUSY_TIME    (ALR_MODE_FRAME_SCAN_TIME + ALR_MODE_PROCESS_TIME)
+#endif
+
+/* 128Hz Refresh rate in Active mode. The scan and process time of the frame
+* must leave at least the minimum MSCLP timer in the refresh rate period */
+#if ((TIME_IN_US / ACTIVE_MODE_REFRESH_RATE) >= (ACTIVE_MODE_FRAME_BUSY_TIME + MINIMUM_TIMER))
     #define ACTIVE_MODE_TIMER           (TIME_IN_US / ACTIVE_MODE_REFRESH_RATE - \
-                                        (ACTIVE_MODE_FRAME_SCAN_TIME + ACTIVE_MODE_PROCESS_TIME))
-#elif
-    #define ACTIVE_MODE_TIMER           (MINIMUM_TIMER)
+                                        ACTIVE_MODE_FRAME_BUSY_TIME)
+#else
+    #error "ACTIVE mode scan and process time exceed the ACTIVE_MODE_REFRESH_RATE period"
 #endif
 
-#if ((TIME_IN_US / ALR_MODE_REFRESH_RATE) > (ALR_MODE_FRAME_SCAN_TIME + ALR_MODE_PROCESS_TIME))
+#if ((TIME_IN_US / ALR_MODE_REFRESH_RATE) >= (ALR_MODE_FRAME_BUSY_TIME + MINIMUM_TIMER))
     #define ALR_MODE_TIMER              (TIME_IN_US / ALR_MODE_REFRESH_RATE - \
-                                            (ALR_MODE_FRAME_SCAN_TIME + ALR_MODE_PROCESS_TIME))
-#elif
-    #define ALR_MODE_TIMER              (MINIMUM_TIMER)
+                                            ALR_MODE_FRAME_BUSY_TIME)
+#else
+    #error "ALR mode scan and process time exceed the ALR_MODE_REFRESH_RATE period"
+#endif
+
+#if ENABLE_SPI_SERIAL_LED
+/* The LED frame must be transmitted and latched within the ACTIVE mode frame
+* period */
+#if ((((LED_BYTES_PER_PACKET * 8u * TIME_IN_US) / SERIAL_LED_SPI_BIT_RATE) + (SERIAL_LED_LATCH_NS / 1000u)) >= \
+     (TIME_IN_US / ACTIVE_MODE_REFRESH_RATE))
+    #error "The NUM_OF_LEDS LED frame and its latch time do not fit in the ACTIVE_MODE_REFRESH_RATE period"
+#endif
+#endif
+
+#if ENABLE_PIPELINED_SCAN
+/* Processing of a frame must complete before the raw counts of the next
+* frame are written, i.e. within the MSCLP timer period */
+#if ((ACTIVE_MODE_PROCESS_TIME >= ACTIVE_MODE_TIMER) || (ALR_MODE_PROCESS_TIME >= ALR_MODE_TIMER))
+    #error "Process time exceeds the MSCLP timer period in pipelined scan mode"
+#endif
+#endif
+
+/* MSCLP timer for a refresh rate level in ACTIVE mode */
+#define REFRESH_RATE_TIMER(rate)        ((TIME_IN_US / (rate)) - ACTIVE_MODE_FRAME_BUSY_TIME)
+
+/* Refresh rate levels, from the highest (ACTIVE mode) to the lowest (ALR mode) */
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+    #define REFRESH_RATE_LEVEL_NUM      (5u)
+#else
+    #define REFRESH_RATE_LEVEL_NUM      (2u)
 #endif
+#define REFRESH_RATE_LEVEL_ACTIVE       (0u)
+#define REFRESH_RATE_LEVEL_ALR          (REFRESH_RATE_LEVEL_NUM - 1u)
 
+/* ACTIVE mode frames without activity before the timeout. With the adaptive
+* refresh rate, a frame of a lower refresh rate level counts as the ACTIVE mode
+* frames of its period, so the timeout stays ACTIVE_MODE_TIMEOUT_SEC */
 #define ACTIVE_MODE_TIMEOUT             (ACTIVE_MODE_REFRESH_RATE * ACTIVE_MODE_TIMEOUT_SEC)
 
 #define ALR_MODE_TIMEOUT                (ALR_MODE_REFRESH_RATE * ALR_MODE_TIMEOUT_SEC)
 
 #define TIMEOUT_RESET                   (0u)
 
-#if ENABLE_RUN_TIME_MEASUREMENT
+#if ENABLE_TRANSITION_HYSTERESIS
+    #if ((TRANSITION_WINDOW_FRAMES > 32u) || (ALR_MODE_ACTIVITY_CONFIRM > TRANSITION_WINDOW_FRAMES))
+        #error "ALR_MODE_ACTIVITY_CONFIRM of TRANSITION_WINDOW_FRAMES, up to 32 frames, is supported"
+    #endif
+    #define TRANSITION_WINDOW_MASK      ((TRANSITION_WINDOW_FRAMES < 32u) ? \
+                                        ((1uL << TRANSITION_WINDOW_FRAMES) - 1u) : 0xFFFFFFFFuL)
+    #if ((PROXIMITY0_PROX_TH + (TRANSITION_UP_HYSTERESIS * PROXIMITY0_HYSTERESIS)) >= PROXIMITY0_TOUCH_TH)
+        #error "The ALR mode transition threshold must stay below the Proximity0 touch threshold"
+    #endif
+    #if ((TRANSITION_DOWN_HYSTERESIS * PROXIMITY0_HYSTERESIS) >= PROXIMITY0_PROX_TH)
+        #error "The ACTIVE mode transition threshold must stay above zero"
+    #endif
+    #define ALR_MODE_CONFIRM_FRAMES     (ALR_MODE_ACTIVITY_CONFIRM)
+    #if (ENABLE_NOISE_MONITOR)
+        #if (NOISY_ALR_MODE_ACTIVITY_CONFIRM > TRANSITION_WINDOW_FRAMES)
+            #error "NOISY_ALR_MODE_ACTIVITY_CONFIRM of TRANSITION_WINDOW_FRAMES is supported"
+        #endif
+        #define ALR_MODE_NOISY_CONFIRM_FRAMES   (NOISY_ALR_MODE_ACTIVITY_CONFIRM)
+    #else
+        #define ALR_MODE_NOISY_CONFIRM_FRAMES   (ALR_MODE_CONFIRM_FRAMES)
+    #endif
+    #define ACTIVE_MODE_DWELL_FRAMES    (ACTIVE_MODE_MIN_DWELL)
+    #define ALR_MODE_DWELL_FRAMES       (ALR_MODE_MIN_DWELL)
+    #define WOT_MODE_DWELL_FRAMES       (WOT_MODE_MIN_DWELL)
+#else
+    /* Every state changes on the first active or timed out frame */
+    #define ALR_MODE_CONFIRM_FRAMES     (1u)
+    #define ALR_MODE_NOISY_CONFIRM_FRAMES   (1u)
+    #define ACTIVE_MODE_DWELL_FRAMES    (0u)
+    #define ALR_MODE_DWELL_FRAMES       (0u)
+    #define WOT_MODE_DWELL_FRAMES       (0u)
+#endif
+
+/* Free running SysTick is used by the run time measurement, the timer
+* calibration and the profiler */
+#define SYS_TICK_EN                     (ENABLE_RUN_TIME_MEASUREMENT || ENABLE_TIMER_CALIBRATION || \
+                                        ENABLE_PROFILER || ENABLE_OVERRUN_MONITOR)
+
+#if SYS_TICK_EN
     #define SYS_TICK_MAX_INTERVAL       (0x00FFFFFF)
-    #define TIME_PER_TICK_IN_US         ((float)TIME_IN_US/CY_CAPSENSE_CPU_CLK)
+    #define TICKS_PER_US                (CY_CAPSENSE_CPU_CLK / TIME_IN_US)
+#endif
+
+/* Scan time of the ACTIVE and ALR mode frames in the overrun budget */
+#if ENABLE_TIMER_CALIBRATION
+    #define OVERRUN_SCAN_TIME           (measuredScanTime)
+#else
+    #define OVERRUN_SCAN_TIME           (ACTIVE_MODE_FRAME_SCAN_TIME)
 #endif
 
 /*****************************************************************************
@@ -142,26 +538,149 @@ typedef enum
                             * with highest refresh rate */
     ALR_MODE = 0x02u,       /* Active-Low Refresh Rate (ALR) mode - All the sensors are
                             * scanned in this state with low refresh rate */
-    WOT_MODE = 0x03u        /* Wake on Touch (WoT) mode - Low Power sensors are scanned
+    WOT_MODE = 0x03u,       /* Wake on Touch (WoT) mode - Low Power sensors are scanned
                             * in this state with lowest refresh rate */
+    BASELINE_MODE = 0x04u,  /* Baseline refresh - A burst of frames of all the sensors is
+                            * scanned between the directly re-armed WOT cycles */
+    APP_STATE_NUM           /* Number of the states, size of the state table */
 } APPLICATION_STATE;
 
+#if ENABLE_TELEMETRY
+/* Build time check that the telemetry transition counters cover all the
+* states, the array size is negative otherwise */
+typedef uint8_t telemetryStateNumCheck_t[(APP_STATE_NUM <= TELEMETRY_STATE_NUM) ? 1 : -1];
+#endif
+
+#if ENABLE_ENERGY_ACCOUNTING
+/* Build time check that the energy accounting covers all the states */
+typedef uint8_t energyStateNumCheck_t[(APP_STATE_NUM <= ENERGY_STATE_NUM) ? 1 : -1];
+#endif
+
+/* The state does not configure the MSCLP timer on entry */
+#define REFRESH_RATE_LEVEL_NONE         (0xFFFFFFFFu)
+
+/*****************************************************************************
+* State descriptor, one per APPLICATION_STATE. AppStateStep() runs the state
+* as follows:
+*  - scan() starts the scan of the frame and waits for its completion
+*  - process() processes the frame and returns true on the widget activity
+*  - the state moves to activeState when activityConfirm, or noisyConfirm
+*    in noisy conditions, of the last
+*    TRANSITION_WINDOW_FRAMES frames are active, otherwise it moves to
+*    idleState, or the state returned by selectIdleState() when it is set,
+*    when more than timeout idle frames are counted
+*  - no state change is done before minDwell frames are spent in the state
+*  - entering a state configures the MSCLP timer as per its refreshRateLevel
+*****************************************************************************/
+typedef struct
+{
+    void (*scan)(void);
+    bool (*process)(void);
+    uint32_t refreshRateLevel;
+    uint32_t timeout;
+    uint32_t activityConfirm;
+    uint32_t noisyConfirm;
+    uint32_t minDwell;
+    APPLICATION_STATE activeState;
+    APPLICATION_STATE idleState;
+    APPLICATION_STATE (*selectIdleState)(void);
+} appStateDescriptor_t;
+
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
+static void InitializeApplication(void);
+static void RunApplicationFrame(void);
+
 static void InitializeCapsense(void);
 static void Capsense_Msc0Isr(void);
 
 static void Ezi2cIsr(void);
 static void InitializeCapsenseTuner(void);
+static void PostAppEvent(uint32_t events);
+static uint32_t TakeAppEvents(uint32_t events);
+#if (ENABLE_TUNER && ENABLE_TUNER_ON_DEMAND)
+static bool IsTunerServiceDue(void);
+#endif
+
+static void SetRefreshRateLevel(uint32_t level);
+static void ConfigureRefreshRateTimer(void);
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+static void UpdateAdaptiveRefreshRate(void);
+#endif
+
+static void WaitForScanComplete(void);
+
+static void AppStateStep(void);
+static void EnterAppState(APPLICATION_STATE state);
+#if ENABLE_TRANSITION_HYSTERESIS
+static uint32_t GetActiveFrameCount(uint32_t history);
+static uint32_t GetTransitionUpDiff(void);
+static uint32_t GetTransitionDownDiff(void);
+#endif
+static void ScanFullFrame(void);
+static void ScanLpFrame(void);
+static bool ProcessFullFrame(void);
+static bool ProcessActiveFrame(void);
+static bool ProcessAlrFrame(void);
+static bool ProcessLpFrame(void);
+#if ENABLE_WOT_AUTO_INTERVAL
+static void InitWotInterval(void);
+static void SetWotIntervalLevel(uint32_t level);
+static void ConfigureWotInterval(void);
+static void UpdateWotInterval(bool activity);
+#endif
+static void StartFrameScan(void);
+#if ENABLE_NOISE_MONITOR
+static void InitNoiseMonitor(void);
+static void UpdateNoiseMonitor(void);
+static void ApplyNoiseConfiguration(void);
+static void CaptureProximityConfiguration(uint32_t shift);
+static void SetProximityConfiguration(uint32_t shift);
+static cy_capsense_status_t CalibrateProximity(void);
+#endif
+static void ApplyPendingConfiguration(void);
+#if ENABLE_WOT_DIRECT_REARM
+static APPLICATION_STATE SelectWotIdleState(void);
+#endif
 
+#if (ENABLE_RUN_TIME_MEASUREMENT || ENABLE_TIMER_CALIBRATION || ENABLE_OVERRUN_MONITOR)
+static uint32_t GetElapsedTicks(uint32_t startTicks);
+#endif
 #if ENABLE_RUN_TIME_MEASUREMENT
 static void StartRuntimeMeasurement();
+static uint32_t GetRuntimeTicks();
 static uint32_t StopRuntimeMeasurement();
 #endif
 
+#if ENABLE_OVERRUN_MONITOR
+static void CheckFrameOverrun(void);
+#endif
+#if ENABLE_BATCHED_REPORT
+static uint32_t GetFramePeriod(void);
+#endif
+#if ENABLE_OVERRUN_DEGRADE
+static bool IsFrameWorkSkipped(void);
+#endif
+
+#if ENABLE_TIMER_CALIBRATION
+static bool IsTimerCalibrationDue(void);
+static void StartScanTimeCalibration(void);
+static void StopScanTimeCalibration(void);
+static void FinishTimerCalibration(void);
+#endif
+
+#if ENABLE_LED_BENCHMARK
+static void RunLedBenchmark(void);
+static bool IsLedBenchmarkFrameValid(const serialLedContext_t *);
+#endif
+
 #if ENABLE_SPI_SERIAL_LED
 void UpdateLeds(void);
+static uint8_t GetProxLedBrightness(void);
+#if ENABLE_LED_ANIMATION
+static uint32_t GetLedAnimationSteps(void);
+#endif
 #endif
 
 void RegisterCallback(void);
@@ -173,11 +692,290 @@ cy_en_syspm_status_t DeepSleepCallback(cy_stc_syspm_callback_params_t *callbackP
 /*******************************************************************************
 * Global Definitions
 *******************************************************************************/
-/* Variables holds the current low power state [ACTIVE, ALR or WOT] */
+/* Variables holds the current low power state [ACTIVE, ALR, WOT or BASELINE] */
 APPLICATION_STATE appState;
 
+/* Idle frames counted in the current state */
+static uint32_t appStateTimeoutCount;
+
+/* Frames spent in the current state, saturates at the minimum dwell */
+static uint32_t appStateFrameCount;
+
+#if ENABLE_TRANSITION_HYSTERESIS
+/* Activity of the last TRANSITION_WINDOW_FRAMES frames of the current state,
+* bit 0 is the last frame */
+static uint32_t appStateActivityHistory;
+#endif
+
+/* State table, an intermediate state is added with its own enum value,
+* refresh rate level and entry here */
+static const appStateDescriptor_t appStateTable[APP_STATE_NUM] =
+{
+    [ACTIVE_MODE] =
+    {
+        .scan               = &ScanFullFrame,
+        .process            = &ProcessActiveFrame,
+        .refreshRateLevel   = REFRESH_RATE_LEVEL_ACTIVE,
+        .timeout            = ACTIVE_MODE_TIMEOUT,
+        .activityConfirm    = 1u,
+        .noisyConfirm       = 1u,
+        .minDwell           = ACTIVE_MODE_DWELL_FRAMES,
+        .activeState        = ACTIVE_MODE,
+        .idleState          = ALR_MODE
+    },
+    [ALR_MODE] =
+    {
+        .scan               = &ScanFullFrame,
+        .process            = &ProcessAlrFrame,
+        .refreshRateLevel   = REFRESH_RATE_LEVEL_ALR,
+        .timeout            = ALR_MODE_TIMEOUT,
+        .activityConfirm    = ALR_MODE_CONFIRM_FRAMES,
+        .noisyConfirm       = ALR_MODE_NOISY_CONFIRM_FRAMES,
+        .minDwell           = ALR_MODE_DWELL_FRAMES,
+        .activeState        = ACTIVE_MODE,
+        .idleState          = WOT_MODE
+    },
+    [WOT_MODE] =
+    {
+        .scan               = &ScanLpFrame,
+        .process            = &ProcessLpFrame,
+        .refreshRateLevel   = REFRESH_RATE_LEVEL_NONE,
+        .timeout            = 0u,
+        .activityConfirm    = 1u,
+        .noisyConfirm       = 1u,
+        .minDwell           = WOT_MODE_DWELL_FRAMES,
+        .activeState        = ACTIVE_MODE,
+        .idleState          = ALR_MODE,
+#if ENABLE_WOT_DIRECT_REARM
+        .selectIdleState    = &SelectWotIdleState
+#endif
+    },
+    [BASELINE_MODE] =
+    {
+        .scan               = &ScanFullFrame,
+        .process            = &ProcessAlrFrame,
+        .refreshRateLevel   = REFRESH_RATE_LEVEL_ALR,
+        .timeout            = WOT_BASELINE_REFRESH_FRAMES - 1u,
+        .activityConfirm    = 1u,
+        .noisyConfirm       = 1u,
+        .minDwell           = WOT_BASELINE_FILTER_FRAMES,
+        .activeState        = ACTIVE_MODE,
+        .idleState          = WOT_MODE
+    }
+};
+
+#if ENABLE_WOT_DIRECT_REARM
+/* Consecutive WOT timeouts without activity, and WOT cycles since the last
+* baseline refresh burst */
+static uint32_t wotIdleCycleCount = 0u;
+static uint32_t wotBaselineCycleCount = 0u;
+#endif
+
+#if (ENABLE_WOT_AUTO_INTERVAL || ENABLE_BATCHED_REPORT)
+/* WOT scan interval of the CAPSENSE configuration in us, read at startup */
+static uint32_t wotScanIntervalConfig = 0u;
+#endif
+
+#if ENABLE_WOT_AUTO_INTERVAL
+/* WOT scan interval doublings configured and requested, the most doublings
+* within WOT_SCAN_INTERVAL_MAX_US, consecutive WOT timeouts without activity at
+* the requested level, and the number of frames in WOT of the CAPSENSE
+* configuration. The requested level is configured before the next WOT frame */
+static uint32_t wotIntervalLevel = 0u;
+static uint32_t wotIntervalTarget = 0u;
+static uint32_t wotIntervalLevelMax = 0u;
+static uint32_t wotIntervalCycleCount = 0u;
+static uint32_t wotTimeoutFrames = 0u;
+static bool wotIntervalPending = false;
+#endif
+
+#if ENABLE_PIPELINED_SCAN
+/* Set when the scan of the next frame is already started */
+static bool nextScanArmed = false;
+
+/* Frames discarded as the armed scan completed before their processing did */
+volatile uint32_t pipelinedFrameDiscardCount = 0u;
+#endif
+
+/* Set when the MSCLP timer of the refresh rate level is not configured yet,
+* as the middleware is busy with the armed frame or rejected the timer */
+static bool refreshRateTimerPending = false;
+
+#if ENABLE_WOT_FAST_WAKE
+/* Set from the WOT frame that detected activity until the first ACTIVE mode
+* frame is processed */
+static bool wotWakeFrame = false;
+#endif
+
+#if ENABLE_ALR_SENTINEL
+/* Set when the scan in progress or last completed is a sentinel frame */
+static bool sentinelFrame = false;
+
+/* ALR sentinel frames left before the next full frame */
+static uint32_t sentinelFramesLeft = 0u;
+#endif
+
+#if ENABLE_NOISE_MONITOR
+/* Proximity0 parameters that follow the number of sub-conversions */
+typedef struct
+{
+    uint16_t numSubConversions;
+    uint16_t fingerTh;
+    uint16_t proxTh;
+    uint16_t noiseTh;
+    uint16_t nNoiseTh;
+    uint16_t hysteresis;
+} proximityConfig_t;
+
+/* Proximity0 parameters of design.cycapsense, used in noisy conditions */
+static proximityConfig_t proximityNoisyConfig;
+
+/* Averaged noise variance of the proximity sensor in counts^2 */
+volatile uint32_t noiseVariance = 0u;
+
+/* Raw count of the last frame, valid when noiseLastRawValid, and the
+* consecutive frames with a diff below the noise threshold */
+static uint32_t noiseLastRaw = 0u;
+static bool noiseLastRawValid = false;
+static uint32_t noiseIdleFrameCount = 0u;
+
+/* Set when the Proximity0 configuration changed, until its baseline and
+* filters are initialized from the first scan of the new configuration */
+static bool proximityBaselinePending = false;
+
+/* Set while the conditions are noisy, the device starts with the
+* configuration of design.cycapsense */
+static bool noisyConditions = true;
+
+/* Set while Proximity0 is scanned with the quiet configuration */
+static bool quietConfigActive = false;
+
+/* Cleared when the calibration of the quiet configuration failed */
+static bool quietConfigUsable = true;
+#endif
+
 cy_stc_scb_ezi2c_context_t ezi2cContext;
 
+/* APP_EVENT_* bits posted by the interrupts, no scan is in progress at start */
+static volatile uint32_t appEvents = APP_EVENT_SCAN_DONE;
+
+/* MSCLP timer of each refresh rate level */
+#if ENABLE_TIMER_CALIBRATION
+static uint32_t refreshRateTimer[REFRESH_RATE_LEVEL_NUM] =
+#else
+static const uint32_t refreshRateTimer[REFRESH_RATE_LEVEL_NUM] =
+#endif
+{
+    ACTIVE_MODE_TIMER,
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+    REFRESH_RATE_TIMER(ADAPTIVE_REFRESH_RATE_LEVEL_1),
+    REFRESH_RATE_TIMER(ADAPTIVE_REFRESH_RATE_LEVEL_2),
+    REFRESH_RATE_TIMER(ADAPTIVE_REFRESH_RATE_LEVEL_3),
+#endif
+    ALR_MODE_TIMER
+};
+
+/* Current refresh rate level */
+static uint32_t refreshRateLevel = REFRESH_RATE_LEVEL_ACTIVE;
+
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+/* Frame period of each refresh rate level in ACTIVE mode frames, fixed point
+* with ADAPTIVE_TIMEOUT_FRAC_BITS fraction bits */
+#define ADAPTIVE_TIMEOUT_FRAC_BITS      (8u)
+#define ADAPTIVE_TIMEOUT_FRAMES(rate)   ((ACTIVE_MODE_REFRESH_RATE << ADAPTIVE_TIMEOUT_FRAC_BITS) / (rate))
+
+static const uint32_t refreshRateTimeoutFrames[REFRESH_RATE_LEVEL_NUM] =
+{
+    ADAPTIVE_TIMEOUT_FRAMES(ACTIVE_MODE_REFRESH_RATE),
+    ADAPTIVE_TIMEOUT_FRAMES(ADAPTIVE_REFRESH_RATE_LEVEL_1),
+    ADAPTIVE_TIMEOUT_FRAMES(ADAPTIVE_REFRESH_RATE_LEVEL_2),
+    ADAPTIVE_TIMEOUT_FRAMES(ADAPTIVE_REFRESH_RATE_LEVEL_3),
+    ADAPTIVE_TIMEOUT_FRAMES(ALR_MODE_REFRESH_RATE)
+};
+
+/* Fraction of an ACTIVE mode frame not yet counted by the ACTIVE mode timeout */
+static uint32_t activeTimeoutFraction = 0u;
+#endif
+
+#if (ENABLE_SPI_SERIAL_LED && ENABLE_LED_ANIMATION)
+/* Frame period of each refresh rate level in ACTIVE mode frames, fixed point
+* with LED_ANIMATION_FRAC_BITS fraction bits */
+#define LED_ANIMATION_FRAMES(rate)      ((ACTIVE_MODE_REFRESH_RATE << LED_ANIMATION_FRAC_BITS) / (rate))
+
+static const uint32_t refreshRateAnimationFrames[REFRESH_RATE_LEVEL_NUM] =
+{
+    LED_ANIMATION_FRAMES(ACTIVE_MODE_REFRESH_RATE),
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+    LED_ANIMATION_FRAMES(ADAPTIVE_REFRESH_RATE_LEVEL_1),
+    LED_ANIMATION_FRAMES(ADAPTIVE_REFRESH_RATE_LEVEL_2),
+    LED_ANIMATION_FRAMES(ADAPTIVE_REFRESH_RATE_LEVEL_3),
+#endif
+    LED_ANIMATION_FRAMES(ALR_MODE_REFRESH_RATE)
+};
+
+/* Fraction of an ACTIVE mode frame not yet stepped by the LED animations */
+static uint32_t ledAnimationFraction = 0u;
+#endif
+
+#if (ENABLE_TIMER_CALIBRATION || ENABLE_OVERRUN_MONITOR || ENABLE_BATCHED_REPORT)
+/* Frame period of each refresh rate level in microseconds */
+static const uint32_t refreshRatePeriod[REFRESH_RATE_LEVEL_NUM] =
+{
+    TIME_IN_US / ACTIVE_MODE_REFRESH_RATE,
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+    TIME_IN_US / ADAPTIVE_REFRESH_RATE_LEVEL_1,
+    TIME_IN_US / ADAPTIVE_REFRESH_RATE_LEVEL_2,
+    TIME_IN_US / ADAPTIVE_REFRESH_RATE_LEVEL_3,
+#endif
+    TIME_IN_US / ALR_MODE_REFRESH_RATE
+};
+#endif
+
+#if ENABLE_TIMER_CALIBRATION
+/* Frames since the last calibration, starts due to calibrate the first frame */
+static uint32_t calibrationFrameCount = TIMER_CALIBRATION_INTERVAL;
+static bool calibrationActive = false;
+static uint32_t calibrationStartTicks;
+static uint32_t calibrationScanTicks;
+static uint32_t calibrationTimer;
+
+/* Busy time of the last measured frames in microseconds, the longest one is
+* applied */
+static uint32_t calibrationBusyTime[TIMER_CALIBRATION_WINDOW];
+static uint32_t calibrationSampleIndex = 0u;
+static uint32_t calibrationSampleCount = 0u;
+
+/* Last measured scan and process time in microseconds */
+volatile uint32_t measuredScanTime = ACTIVE_MODE_FRAME_SCAN_TIME;
+volatile uint32_t measuredProcessTime = ACTIVE_MODE_PROCESS_TIME;
+#endif
+
+#if ENABLE_OVERRUN_MONITOR
+/* SysTick value at the last scan complete interrupt */
+static volatile uint32_t scanDoneTicks;
+
+/* Set when the last scan started was an ACTIVE or ALR mode frame */
+static bool frameScanStarted = false;
+
+/* Ticks allowed from the scan complete interrupt to the next scan start at
+* the current refresh rate level */
+static uint32_t frameBudgetTicks;
+
+/* Overruns counted and the worst lateness in microseconds */
+volatile uint32_t frameOverrunCount = 0u;
+volatile uint32_t frameMaxLateness = 0u;
+#endif
+
+#if ENABLE_OVERRUN_DEGRADE
+/* Set by an overrun until the main loop decides on the LED and Tuner work */
+static bool frameOverrunPending = false;
+#endif
+
+#if ENABLE_BATCHED_REPORT
+/* Nominal period of the last frame in microseconds */
+static uint32_t reportFramePeriod = 0u;
+#endif
+
 #if ENABLE_SPI_SERIAL_LED
 extern cy_stc_scb_spi_context_t UserSpiContext;
 extern serialLedContext_t ledContext;
@@ -246,7 +1044,31 @@ cy_stc_syspm_callback_t deepSleepCb =
 };
 
 #if ENABLE_RUN_TIME_MEASUREMENT
+/* SysTick value at StartRuntimeMeasurement() */
+static uint32_t runtimeStartTicks;
+
 volatile uint32_t processTime = 0u;
+
+/* Process time of the last frame of each state in microseconds */
+volatile uint32_t appStateRunTime[APP_STATE_NUM];
+
+#if ENABLE_SPI_SERIAL_LED
+/* CPU cycles taken by EncodeSerialLed(); build with SERIAL_LED_LUT_ENCODER_EN
+* set to 0 and 1 to compare the bitwise and look-up table encoders */
+volatile uint32_t ledEncodeCycles = 0u;
+#endif
+#endif
+
+#if ENABLE_LED_BENCHMARK
+extern uint8_t ledTxBuffer[LED_BYTES_PER_PACKET];
+
+/* Startup LED encoder benchmark: average and worst CPU cycles per frame, the
+* frames different from the reference encoder and whether the worst frame
+* exceeds the SERIAL_LED_PROCESS_TIME budget */
+volatile uint32_t ledBenchmarkAvgCycles = 0u;
+volatile uint32_t ledBenchmarkMaxCycles = 0u;
+volatile uint32_t ledBenchmarkErrors = 0u;
+volatile bool ledBenchmarkOverBudget = false;
 #endif
 
 /*******************************************************************************
@@ -266,22 +1088,37 @@ volatile uint32_t processTime = 0u;
 *******************************************************************************/
 int main(void)
 {
-    cy_rslt_t result;
-    uint32_t appStateTimeoutCount;
-    uint32_t interruptStatus;
+    InitializeApplication();
 
-#if ENABLE_RUN_TIME_MEASUREMENT
-    static uint32_t activeModeRunTime;
-    static uint32_t alrModeRunTime;
-#endif
+    for (;;)
+    {
+        RunApplicationFrame();
+    }
+}
+
+/*******************************************************************************
+* Function Name: InitializeApplication
+********************************************************************************
+* Summary:
+*  Initializes the device, the CAPSENSE, the tuner communication and the serial
+*  LED, and starts in ACTIVE mode.
+*
+*******************************************************************************/
+static void InitializeApplication(void)
+{
+    cy_rslt_t result;
 
     /* Initialize the device and board peripherals */
     result = cybsp_init() ;
 
-#if ENABLE_RUN_TIME_MEASUREMENT
+#if SYS_TICK_EN
     Cy_SysTick_Init (CY_SYSTICK_CLOCK_SOURCE_CLK_CPU ,SYS_TICK_MAX_INTERVAL);
 #endif
 
+#if ENABLE_TELEMETRY
+    InitTelemetry();
+#endif
+
     /* Board init failed. Stop program execution */
     if (result != CY_RSLT_SUCCESS)
     {
@@ -307,16 +1144,49 @@ int main(void)
     Cy_GPIO_SetDrivemode(CYBSP_SERIAL_LED_PORT, CYBSP_SERIAL_LED_NUM, CY_GPIO_DM_ANALOG);
 #endif
 
+#if ENABLE_LED_BENCHMARK
+    /* Measures and checks the LED frame encoder before the first frame */
+    RunLedBenchmark();
+#endif
+
     /* Register callbacks */
     RegisterCallback();
 
     /* Define initial state of the device and the corresponding refresh rate*/
     appState = ACTIVE_MODE;
     appStateTimeoutCount = 0u;
+    appStateFrameCount = 0u;
+#if ENABLE_ENERGY_ACCOUNTING
+    EnergySetState((uint8_t)appState);
+#endif
 
     /* Initialize MSC CAPSENSE */
     InitializeCapsense();
 
+#if ENABLE_NOISE_MONITOR
+    InitNoiseMonitor();
+#endif
+
+#if ENABLE_TRANSITION_HYSTERESIS
+    /* The build time check of the transition thresholds used these values */
+    CY_ASSERT((PROXIMITY0_PROX_TH == cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID].proxTh) &&
+              (PROXIMITY0_TOUCH_TH == cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID].fingerTh) &&
+              (PROXIMITY0_HYSTERESIS == cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID].hysteresis));
+#endif
+
+#if (ENABLE_WOT_AUTO_INTERVAL || ENABLE_BATCHED_REPORT)
+    wotScanIntervalConfig = cy_capsense_context.ptrInternalContext->wotScanInterval;
+#endif
+
+#if ENABLE_WOT_AUTO_INTERVAL
+    InitWotInterval();
+#endif
+
+#if ENABLE_BASELINE_SNAPSHOT
+    /* Baselines of the last idle baseline refresh burst before the power loss */
+    (void)RestoreBaselineSnapshot();
+#endif
+
 #if ENABLE_SPI_SERIAL_LED
     /* Serial LED control for showing the CAPSENSE touch status and power mode */
     UpdateLeds();
@@ -326,165 +1196,1184 @@ int main(void)
     Cy_CapSense_IloCompensate(&cy_capsense_context);
 
     /* Configure the MSCLP wake up timer as per the ACTIVE mode refresh rate */
-    Cy_CapSense_ConfigureMsclpTimer(ACTIVE_MODE_TIMER, &cy_capsense_context);
+    SetRefreshRateLevel(REFRESH_RATE_LEVEL_ACTIVE);
+}
 
+/*******************************************************************************
+* Function Name: RunApplicationFrame
+********************************************************************************
+* Summary:
+*  Runs one pass of the main loop: scans and processes the frame of the current
+*  state, then refreshes the LEDs, the host interface and the tuner.
+*
+*******************************************************************************/
+static void RunApplicationFrame(void)
+{
+#if ENABLE_OVERRUN_DEGRADE
+    bool frameWorkSkipped;
+#endif
 
-    for (;;)
-    {
-        switch(appState)
-        {
-            /* Active Refresh-rate Mode */
-            case ACTIVE_MODE:
+    /* Scan, process and move to the next state as per the state table */
+    AppStateStep();
 
-                Cy_CapSense_ScanAllSlots(&cy_capsense_context);
+#if ENABLE_OVERRUN_DEGRADE
+    frameWorkSkipped = IsFrameWorkSkipped();
+#endif
 
-                interruptStatus = Cy_SysLib_EnterCriticalSection();
+#if ENABLE_SPI_SERIAL_LED
+#if ENABLE_OVERRUN_DEGRADE
+    if (!frameWorkSkipped)
+#endif
+    {
+        /* Refresh LEDs to show latest status */
+        PROFILER_START(PROFILER_STAGE_UPDATE_LEDS);
+        UpdateLeds();
+        PROFILER_STOP(PROFILER_STAGE_UPDATE_LEDS);
+    }
+#endif
 
-                while (Cy_CapSense_IsBusy(&cy_capsense_context))
-                {
-                    Cy_SysPm_CpuEnterDeepSleep();
+#if ENABLE_TELEMETRY
+    /* Publish the status of this frame to the host */
+    UpdateTelemetry((uint8_t)appState);
+#endif
 
-                    Cy_SysLib_ExitCriticalSection(interruptStatus);
-                    interruptStatus = Cy_SysLib_EnterCriticalSection();
-                }
-                Cy_SysLib_ExitCriticalSection(interruptStatus);
+#if ENABLE_BATCHED_REPORT
+    /* Aggregate the status of this frame in the host report */
+    ReportFrame((uint8_t)appState, reportFramePeriod, (0u != TakeAppEvents(APP_EVENT_HOST_READ)));
+#endif
 
-#if ENABLE_RUN_TIME_MEASUREMENT
-                activeModeRunTime = 0u;
-                StartRuntimeMeasurement();
-#endif
-                Cy_CapSense_ProcessAllWidgets(&cy_capsense_context);
-
-                /* Scan, process and check the status of the all Active mode sensors */
-                if(Cy_CapSense_IsAnyWidgetActive(&cy_capsense_context))
-                {
-                    appStateTimeoutCount = TIMEOUT_RESET;
-                }
-                else
-                {
-                    appStateTimeoutCount++;
-
-                    if(ACTIVE_MODE_TIMEOUT < appStateTimeoutCount)
-                    {
-                        appState = ALR_MODE;
-                        appStateTimeoutCount = TIMEOUT_RESET;
-
-                        /* Configure the MSCLP wake up timer as per the ALR mode refresh rate */
-                        Cy_CapSense_ConfigureMsclpTimer(ALR_MODE_TIMER, &cy_capsense_context);
-                    }
-                }
+#if ENABLE_TUNER
+    /* Establishes synchronized communication with the CAPSENSE&trade; Tuner tool */
+#if ENABLE_OVERRUN_DEGRADE
+    if (!frameWorkSkipped)
+#endif
+#if ENABLE_TUNER_ON_DEMAND
+    if (IsTunerServiceDue())
+#endif
+    {
+        PROFILER_START(PROFILER_STAGE_RUN_TUNER);
+        Cy_CapSense_RunTuner(&cy_capsense_context);
+        PROFILER_STOP(PROFILER_STAGE_RUN_TUNER);
+    }
+#endif
 
-#if ENABLE_RUN_TIME_MEASUREMENT
-                activeModeRunTime = StopRuntimeMeasurement();
+#if ENABLE_TIMER_CALIBRATION
+    FinishTimerCalibration();
 #endif
-                break;
-                /* End of ACTIVE_MODE */
+}
 
-            /* Active Low Refresh-rate Mode */
-            case ALR_MODE :
+/*******************************************************************************
+* Function Name: WaitForScanComplete
+********************************************************************************
+* Summary:
+*  Keeps the CPU in Deep Sleep until the CAPSENSE scan is complete. CPU Sleep is
+*  used instead when Deep Sleep is refused while a LED frame is sent, or while
+*  the timer calibration measures the frame.
+*
+*******************************************************************************/
+static void WaitForScanComplete(void)
+{
+    uint32_t interruptStatus;
 
-                Cy_CapSense_ScanAllSlots(&cy_capsense_context);
-                
-                interruptStatus = Cy_SysLib_EnterCriticalSection();
+    interruptStatus = Cy_SysLib_EnterCriticalSection();
 
-                while (Cy_CapSense_IsBusy(&cy_capsense_context))
-                {
-                    Cy_SysPm_CpuEnterDeepSleep();
+    /* Wake ups by other interrupts, e.g. the host I2C traffic, go straight
+    * back to sleep */
+    while (0u == (appEvents & APP_EVENT_SCAN_DONE))
+    {
+#if ENABLE_TIMER_CALIBRATION
+        if (calibrationActive)
+        {
+            /* SysTick keeps counting in CPU Sleep */
+            ENERGY_SET_DOMAIN(ENERGY_DOMAIN_CPU_SLEEP);
+            Cy_SysPm_CpuEnterSleep();
+            ENERGY_SET_DOMAIN(ENERGY_DOMAIN_CPU_ACTIVE);
+        }
+        else
+#endif
+        if (CY_SYSPM_SUCCESS != Cy_SysPm_CpuEnterDeepSleep())
+        {
+            /* Deep Sleep is refused while a LED frame is sent */
+            ENERGY_DEEP_SLEEP_REFUSED();
+            ENERGY_SET_DOMAIN(ENERGY_DOMAIN_CPU_SLEEP);
+            Cy_SysPm_CpuEnterSleep();
+            ENERGY_SET_DOMAIN(ENERGY_DOMAIN_CPU_ACTIVE);
+        }
+
+        Cy_SysLib_ExitCriticalSection(interruptStatus);
+        interruptStatus = Cy_SysLib_EnterCriticalSection();
+    }
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+}
+
+/*******************************************************************************
+* Function Name: AppStateStep
+********************************************************************************
+* Summary:
+*  Runs one frame of the current state: scans and processes the frame, then
+*  moves to the next state as per the state descriptor.
+*
+*******************************************************************************/
+static void AppStateStep(void)
+{
+    const appStateDescriptor_t * state;
+    bool activity;
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+    uint32_t frameLevel;
+#endif
+
+    if ((APP_STATE_NUM <= appState) || (NULL == appStateTable[appState].scan))
+    {
+        /** Unknown power mode state. Unexpected situation. **/
+        CY_ASSERT(CY_ASSERT_FAILED);
+        return;
+    }
+
+    state = &appStateTable[appState];
+
+#if ENABLE_BATCHED_REPORT
+    reportFramePeriod = GetFramePeriod();
+#endif
+
+    state->scan();
+
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+    /* Level of the frame just scanned, the processing may change it */
+    frameLevel = refreshRateLevel;
+#endif
+
+#if ENABLE_RUN_TIME_MEASUREMENT
+    StartRuntimeMeasurement();
+#endif
+
+    activity = state->process();
+    MARKER_TOGGLE(PROCESS_DONE);
+
+#if ENABLE_RUN_TIME_MEASUREMENT
+    appStateRunTime[appState] = StopRuntimeMeasurement();
+#endif
+
+#if ENABLE_PIPELINED_SCAN
+    if (nextScanArmed && (0u != (appEvents & APP_EVENT_SCAN_DONE)))
+    {
+        /* The raw counts of the armed frame may have been written during the
+        * processing, the result of this frame is discarded. The armed frame
+        * is processed with its own raw counts */
+        if (UINT32_MAX != pipelinedFrameDiscardCount)
+        {
+            pipelinedFrameDiscardCount++;
+        }
+        return;
+    }
+#endif
+
+    if (appStateFrameCount < state->minDwell)
+    {
+        appStateFrameCount++;
+    }
+
+#if ENABLE_TRANSITION_HYSTERESIS
+    appStateActivityHistory = ((appStateActivityHistory << 1u) | (activity ? 1u : 0u)) &
+                              TRANSITION_WINDOW_MASK;
+    /* A single active frame does not reset the timeout until it is confirmed */
+#if ENABLE_NOISE_MONITOR
+    if (noisyConditions)
+    {
+        activity = activity && (GetActiveFrameCount(appStateActivityHistory) >= state->noisyConfirm);
+    }
+    else
+#endif
+    {
+        activity = activity && (GetActiveFrameCount(appStateActivityHistory) >= state->activityConfirm);
+    }
+#endif
+
+    if (activity)
+    {
+        appStateTimeoutCount = TIMEOUT_RESET;
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+        activeTimeoutFraction = 0u;
+#endif
+
+        if ((state->activeState != appState) && (appStateFrameCount >= state->minDwell))
+        {
+            EnterAppState(state->activeState);
+        }
+    }
+    else
+    {
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+        if (ACTIVE_MODE == appState)
+        {
+            /* The ACTIVE mode timeout counts the time, the frames of the lower
+            * adaptive refresh rate levels are longer */
+            activeTimeoutFraction += refreshRateTimeoutFrames[frameLevel];
+            appStateTimeoutCount += activeTimeoutFraction >> ADAPTIVE_TIMEOUT_FRAC_BITS;
+            activeTimeoutFraction &= ((1uL << ADAPTIVE_TIMEOUT_FRAC_BITS) - 1u);
+        }
+        else
+#endif
+        {
+            appStateTimeoutCount++;
+        }
+
+#if ENABLE_BASELINE_SNAPSHOT
+        if ((BASELINE_MODE == appState) && (state->timeout < appStateTimeoutCount)
+#if ENABLE_NOISE_MONITOR
+            /* The snapshot is restored at boot with the design.cycapsense configuration */
+            && (!quietConfigActive)
+#endif
+            )
+        {
+            /* Last frame of an idle baseline refresh burst, no scan in progress */
+            UpdateBaselineSnapshot();
+        }
+#endif
+
+        if ((state->timeout < appStateTimeoutCount) && (appStateFrameCount >= state->minDwell))
+        {
+            EnterAppState((NULL != state->selectIdleState) ? state->selectIdleState() : state->idleState);
+        }
+    }
+}
+
+#if ENABLE_TRANSITION_HYSTERESIS
+/*******************************************************************************
+* Function Name: GetActiveFrameCount
+********************************************************************************
+* Summary:
+*  Counts the active frames in the activity history.
+*
+* Parameters:
+*  history: activity history, one bit per frame
+*
+* Return:
+*  number of active frames
+*
+*******************************************************************************/
+static uint32_t GetActiveFrameCount(uint32_t history)
+{
+    uint32_t count = 0u;
+
+    while (0u != history)
+    {
+        /* Clears the lowest set bit */
+        history &= (history - 1u);
+        count++;
+    }
+
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: GetTransitionUpDiff
+********************************************************************************
+* Summary:
+*  Returns the proximity diff count that an ALR mode frame needs to be active,
+*  from the proximity threshold and hysteresis of Proximity0. It is kept below
+*  the touch threshold, so a touch always moves to ACTIVE mode.
+*
+* Return:
+*  proximity diff count
+*
+*******************************************************************************/
+static uint32_t GetTransitionUpDiff(void)
+{
+    const cy_stc_capsense_widget_context_t * prox = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID];
+    uint32_t upDiff = (uint32_t)prox->proxTh + (TRANSITION_UP_HYSTERESIS * (uint32_t)prox->hysteresis);
+
+    return (upDiff < prox->fingerTh) ? upDiff : prox->fingerTh;
+}
+
+/*******************************************************************************
+* Function Name: GetTransitionDownDiff
+********************************************************************************
+* Summary:
+*  Returns the proximity diff count below which an ACTIVE mode frame without
+*  widget activity is idle, from the proximity threshold and hysteresis of
+*  Proximity0. The proximity threshold is used when the hysteresis is larger.
+*
+* Return:
+*  proximity diff count
+*
+*******************************************************************************/
+static uint32_t GetTransitionDownDiff(void)
+{
+    const cy_stc_capsense_widget_context_t * prox = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID];
+    uint32_t margin = TRANSITION_DOWN_HYSTERESIS * (uint32_t)prox->hysteresis;
+
+    return (prox->proxTh > margin) ? ((uint32_t)prox->proxTh - margin) : prox->proxTh;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: EnterAppState
+********************************************************************************
+* Summary:
+*  Moves to the state and configures the MSCLP wake up timer as per its refresh
+*  rate level.
+*
+* Parameters:
+*  state: the next application state
+*
+*******************************************************************************/
+static void EnterAppState(APPLICATION_STATE state)
+{
+    if ((WOT_MODE == appState) && (ACTIVE_MODE == state))
+    {
+        MARKER_TOGGLE(WOT_WAKE);
+    }
+
+#if ENABLE_TELEMETRY
+    CountTelemetryTransition((uint8_t)appState, (uint8_t)state);
+#endif
+
+#if ENABLE_NOISE_MONITOR
+    if (WOT_MODE == appState)
+    {
+        /* The raw count drifted during WOT mode */
+        noiseLastRawValid = false;
+    }
+#endif
+
+#if ENABLE_WOT_DIRECT_REARM
+    if (ACTIVE_MODE == state)
+    {
+        /* WOT timeouts are counted again after the user activity */
+        wotIdleCycleCount = 0u;
+    }
+#endif
+
+#if ENABLE_WOT_AUTO_INTERVAL
+    if (ACTIVE_MODE == state)
+    {
+        /* Short WOT scan interval after the user activity, also when it is
+        * detected in ALR mode */
+        UpdateWotInterval(true);
+    }
+#endif
+
+#if ENABLE_ENERGY_ACCOUNTING
+    EnergySetState((uint8_t)state);
+#endif
+
+    appState = state;
+    appStateTimeoutCount = TIMEOUT_RESET;
+    appStateFrameCount = 0u;
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+    activeTimeoutFraction = 0u;
+#endif
+#if ENABLE_TRANSITION_HYSTERESIS
+    appStateActivityHistory = 0u;
+#endif
+
+    if (REFRESH_RATE_LEVEL_NONE != appStateTable[state].refreshRateLevel)
+    {
+        SetRefreshRateLevel(appStateTable[state].refreshRateLevel);
+    }
+}
+
+/*******************************************************************************
+* Function Name: ScanFullFrame
+********************************************************************************
+* Summary:
+*  Scans all the slots of the ACTIVE and ALR mode frame and waits for the scan
+*  completion. With the pipelined scan the next frame is armed right after the
+*  raw counts are captured, unless this frame can time out the state.
+*
+*******************************************************************************/
+static void ScanFullFrame(void)
+{
+#if ENABLE_PIPELINED_SCAN
+    if (!nextScanArmed)
+    {
+#endif
+#if ENABLE_WOT_FAST_WAKE
+        if (wotWakeFrame)
+        {
+            /* Start the first frame after the wake up without the timer period.
+            * The calibration is postponed to the next frame */
+            Cy_CapSense_ConfigureMsclpTimer(MINIMUM_TIMER, &cy_capsense_context);
+        }
+        else
+#endif
+        {
+            ApplyPendingConfiguration();
+#if ENABLE_TIMER_CALIBRATION
+            StartScanTimeCalibration();
+#endif
+        }
+        StartFrameScan();
+#if ENABLE_PIPELINED_SCAN
+    }
+#endif
+
+    WaitForScanComplete();
+
+#if ENABLE_PIPELINED_SCAN
+    /* Raw counts of this frame are captured, the MSCLP is idle */
+    nextScanArmed = false;
+#endif
+
+#if ENABLE_WOT_FAST_WAKE
+    if (wotWakeFrame)
+    {
+        /* Restore the timer of the refresh rate for the next frames */
+        SetRefreshRateLevel(refreshRateLevel);
+    }
+#endif
+
+#if ENABLE_TIMER_CALIBRATION
+    StopScanTimeCalibration();
+#endif
+
+#if ENABLE_PIPELINED_SCAN
+    /* Arm the next frame, its scan starts when the MSCLP timer expires. A
+    * refresh rate level or noise condition changed by the previous frame is
+    * configured first */
+    ApplyPendingConfiguration();
+
+    /* The frame that ends the state when it is idle arms nothing, the next
+    * state may scan other slots. The calibration frame starts its own scan
+    * to be measured */
+    if ((appStateTimeoutCount < appStateTable[appState].timeout)
+#if ENABLE_TIMER_CALIBRATION
+        && (!IsTimerCalibrationDue())
+#endif
+        )
+    {
+        StartFrameScan();
+        nextScanArmed = true;
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: ApplyPendingConfiguration
+********************************************************************************
+* Summary:
+*  Applies the configuration changed since the last scan start: the Proximity0
+*  configuration of the noise conditions, the MSCLP timer of the refresh rate
+*  level and the WOT scan interval. Called while no scan is in progress.
+*
+*******************************************************************************/
+static void ApplyPendingConfiguration(void)
+{
+#if ENABLE_NOISE_MONITOR
+    ApplyNoiseConfiguration();
+#endif
+
+    if (refreshRateTimerPending)
+    {
+        ConfigureRefreshRateTimer();
+    }
+
+#if ENABLE_WOT_AUTO_INTERVAL
+    ConfigureWotInterval();
+#endif
+}
+
+/*******************************************************************************
+* Function Name: StartFrameScan
+********************************************************************************
+* Summary:
+*  Starts the scan of the ACTIVE or ALR mode frame: only the proximity widget
+*  for an ALR sentinel frame, otherwise all the slots.
+*
+*******************************************************************************/
+static void StartFrameScan(void)
+{
+#if ENABLE_OVERRUN_MONITOR
+    CheckFrameOverrun();
+#endif
+
+    (void)TakeAppEvents(APP_EVENT_SCAN_DONE);
+    MARKER_TOGGLE(SCAN_START);
+
+#if ENABLE_ALR_SENTINEL
+    sentinelFrame = ((ALR_MODE == appState) && (0u != sentinelFramesLeft));
+#if ENABLE_NOISE_MONITOR
+    sentinelFrame = sentinelFrame && (!noisyConditions);
+#endif
+
+    if (sentinelFrame)
+    {
+        Cy_CapSense_ScanWidget(CY_CAPSENSE_PROXIMITY0_WDGT_ID, &cy_capsense_context);
+        return;
+    }
+#endif
+
+    Cy_CapSense_ScanAllSlots(&cy_capsense_context);
+}
+
+#if ENABLE_OVERRUN_MONITOR
+/*******************************************************************************
+* Function Name: CheckFrameOverrun
+********************************************************************************
+* Summary:
+*  Compares the ticks since the scan complete interrupt of the previous ACTIVE
+*  or ALR mode frame against the budget of the refresh rate level, and counts
+*  the overrun and the lateness. Called right before the scan is started. The
+*  ticks are only valid while the CPU does not enter Deep Sleep, which holds
+*  from the scan complete interrupt to the next scan start. Gaps longer than
+*  the SysTick wrap of about 350 ms are not detected.
+*
+*******************************************************************************/
+static void CheckFrameOverrun(void)
+{
+    uint32_t elapsedTicks;
+    uint32_t lateness;
+
+    if (frameScanStarted)
+    {
+        elapsedTicks = GetElapsedTicks(scanDoneTicks);
+
+        if (elapsedTicks > frameBudgetTicks)
+        {
+            lateness = (elapsedTicks - frameBudgetTicks) / TICKS_PER_US;
+
+            if (UINT32_MAX != frameOverrunCount)
+            {
+                frameOverrunCount++;
+            }
+            if (lateness > frameMaxLateness)
+            {
+                frameMaxLateness = lateness;
+            }
+
+#if ENABLE_TELEMETRY
+            SetTelemetryOverrun(frameOverrunCount, frameMaxLateness);
+#endif
+#if ENABLE_OVERRUN_DEGRADE
+            frameOverrunPending = true;
+#endif
+        }
+    }
+
+    frameScanStarted = true;
+}
+#endif
+
+#if ENABLE_BATCHED_REPORT
+/*******************************************************************************
+* Function Name: GetFramePeriod
+********************************************************************************
+* Summary:
+*  Returns the nominal period of the frame of the current state: the refresh
+*  rate period, or the WOT timeout in WOT mode. A WOT frame ended by a touch
+*  is shorter, so the report timestamps are estimates.
+*
+* Return:
+*  frame period in microseconds
+*
+*******************************************************************************/
+static uint32_t GetFramePeriod(void)
+{
+    uint32_t wotScanInterval = wotScanIntervalConfig;
+
+    if (WOT_MODE != appState)
+    {
+        return refreshRatePeriod[refreshRateLevel];
+    }
+
+#if ENABLE_WOT_AUTO_INTERVAL
+    wotScanInterval <<= wotIntervalLevel;
+#endif
+
+    return wotScanInterval * cy_capsense_context.ptrInternalContext->wotTimeout;
+}
+#endif
+
+#if ENABLE_OVERRUN_DEGRADE
+/*******************************************************************************
+* Function Name: IsFrameWorkSkipped
+********************************************************************************
+* Summary:
+*  Decides whether the LED and Tuner work of this main loop pass is skipped,
+*  to catch up after an overrun. The work is skipped at most every other pass,
+*  so permanent overruns halve the LED and Tuner update rate instead of
+*  stopping them.
+*
+* Return:
+*  true to skip the LED and Tuner work
+*
+*******************************************************************************/
+static bool IsFrameWorkSkipped(void)
+{
+    static bool skipped = false;
+
+    skipped = frameOverrunPending && !skipped;
+    frameOverrunPending = false;
+
+    return skipped;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: ScanLpFrame
+********************************************************************************
+* Summary:
+*  Scans the low power widget slots and stays in Deep Sleep until WOT timeout
+*  or a touch is detected.
+*
+*******************************************************************************/
+static void ScanLpFrame(void)
+{
+#if ENABLE_PIPELINED_SCAN
+    /* The last frame before WOT mode does not arm the next one, this only
+    * keeps the MSCLP from being reconfigured in the middle of a scan */
+    if (nextScanArmed)
+    {
+        WaitForScanComplete();
+        nextScanArmed = false;
+    }
+#endif
+
+    ApplyPendingConfiguration();
+
+#if ENABLE_OVERRUN_MONITOR
+    /* The WOT frame has no refresh rate period */
+    frameScanStarted = false;
+#endif
+
+    /* Trigger the low power widget scan */
+    (void)TakeAppEvents(APP_EVENT_SCAN_DONE);
+    MARKER_TOGGLE(SCAN_START);
+    Cy_CapSense_ScanAllLpSlots(&cy_capsense_context);
+
+    /* Enter and stay in Deep Sleep until WOT timeout or a touch is detected. */
+    /* WOT Timeout = WOT scan interval x Num of frames in WOT (in uSec); 
+    * Refer to Wake-On-Touch settings in CAPSENSE Configurator for WOT Timeout*/
+    WaitForScanComplete();
+}
+
+/*******************************************************************************
+* Function Name: ProcessFullFrame
+********************************************************************************
+* Summary:
+*  Processes all the widgets of the ACTIVE and ALR mode frame, or only the
+*  proximity widget of an ALR sentinel frame.
+*
+* Return:
+*  true if any widget is active
+*
+*******************************************************************************/
+static bool ProcessFullFrame(void)
+{
+    PROFILER_START(PROFILER_STAGE_PROCESS_WIDGETS);
+#if ENABLE_NOISE_MONITOR
+    if (proximityBaselinePending)
+    {
+        /* First scan of the new Proximity0 configuration */
+        Cy_CapSense_InitializeWidgetBaseline(CY_CAPSENSE_PROXIMITY0_WDGT_ID, &cy_capsense_context);
+        Cy_CapSense_InitializeWidgetFilter(CY_CAPSENSE_PROXIMITY0_WDGT_ID, &cy_capsense_context);
+        proximityBaselinePending = false;
+    }
+#endif
+#if ENABLE_ALR_SENTINEL
+    if (sentinelFrame)
+    {
+        Cy_CapSense_ProcessWidget(CY_CAPSENSE_PROXIMITY0_WDGT_ID, &cy_capsense_context);
+    }
+    else
+#endif
+    {
+        Cy_CapSense_ProcessAllWidgets(&cy_capsense_context);
+    }
+    PROFILER_STOP(PROFILER_STAGE_PROCESS_WIDGETS);
+
+#if ENABLE_NOISE_MONITOR
+    UpdateNoiseMonitor();
+#endif
+
+#if ENABLE_WOT_FAST_WAKE
+    /* The proximity status is up to date from now on */
+    wotWakeFrame = false;
+#endif
+
+    return (0u != Cy_CapSense_IsAnyWidgetActive(&cy_capsense_context));
+}
+
+#if ENABLE_NOISE_MONITOR
+/*******************************************************************************
+* Function Name: UpdateNoiseMonitor
+********************************************************************************
+* Summary:
+*  Averages the square of the raw count change of the proximity sensor from
+*  the last frame, with an exponential filter of weight 2^-NOISE_FILTER_SHIFT,
+*  over the frames with a diff below the noise threshold. A target approaching
+*  below the proximity threshold is not counted as noise. Switches between
+*  quiet and noisy conditions with the NOISE_LOW_VARIANCE and
+*  NOISE_HIGH_VARIANCE hysteresis, after NOISE_SWITCH_IDLE_FRAMES of these
+*  frames in a row. The new configuration is applied before the next scan
+*  start.
+*
+*******************************************************************************/
+static void UpdateNoiseMonitor(void)
+{
+    const cy_stc_capsense_sensor_context_t * prox = &cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID];
+    uint32_t noiseTh = cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID].noiseTh;
+    uint32_t raw = prox->raw;
+    uint32_t lastRaw = noiseLastRaw;
+    uint32_t deviation;
+    uint32_t variance = noiseVariance;
+    bool lastRawValid = noiseLastRawValid;
+
+    noiseLastRaw = raw;
+    noiseLastRawValid = true;
+
+    if ((prox->diff >= noiseTh) ||
+        (0u != Cy_CapSense_IsWidgetActive(CY_CAPSENSE_PROXIMITY0_WDGT_ID, &cy_capsense_context)))
+    {
+        /* The signal of a target is not noise */
+        noiseIdleFrameCount = 0u;
+        return;
+    }
+
+    if (noiseIdleFrameCount < NOISE_SWITCH_IDLE_FRAMES)
+    {
+        noiseIdleFrameCount++;
+    }
+
+    if (!lastRawValid)
+    {
+        return;
+    }
+
+    deviation = (raw > lastRaw) ? (raw - lastRaw) : (lastRaw - raw);
+
+    /* Saturates, so the square fits in 32 bits */
+    if (deviation > UINT16_MAX)
+    {
+        deviation = UINT16_MAX;
+    }
+
+    variance = variance - (variance >> NOISE_FILTER_SHIFT) + ((deviation * deviation) >> NOISE_FILTER_SHIFT);
+    noiseVariance = variance;
+
+    if (noiseIdleFrameCount < NOISE_SWITCH_IDLE_FRAMES)
+    {
+        /* Not idle for long enough to recalibrate Proximity0 */
+    }
+    else if (variance > NOISE_HIGH_VARIANCE(noiseTh))
+    {
+        noisyConditions = true;
+    }
+    else if (variance < NOISE_LOW_VARIANCE(noiseTh))
+    {
+        noisyConditions = false;
+    }
+    else
+    {
+        /* Keeps the conditions within the hysteresis band */
+    }
+}
+
+/*******************************************************************************
+* Function Name: InitNoiseMonitor
+********************************************************************************
+* Summary:
+*  Stores the Proximity0 configuration of design.cycapsense, used in noisy
+*  conditions. The noise variance starts at the noisy limit, so the quiet
+*  configuration is selected only after the filter has settled.
+*
+*******************************************************************************/
+static void InitNoiseMonitor(void)
+{
+    const cy_stc_capsense_widget_context_t * wd = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID];
 
-                    Cy_SysLib_ExitCriticalSection(interruptStatus);
-                    interruptStatus = Cy_SysLib_EnterCriticalSection();
-                }
-                Cy_SysLib_ExitCriticalSection(interruptStatus);
+    proximityNoisyConfig.numSubConversions = wd->numSubConversions;
+    proximityNoisyConfig.fingerTh = wd->fingerTh;
+    proximityNoisyConfig.proxTh = wd->proxTh;
+    proximityNoisyConfig.noiseTh = wd->noiseTh;
+    proximityNoisyConfig.nNoiseTh = wd->nNoiseTh;
+    proximityNoisyConfig.hysteresis = wd->hysteresis;
 
-#if ENABLE_RUN_TIME_MEASUREMENT
-                alrModeRunTime = 0u;
-                StartRuntimeMeasurement();
+    noiseVariance = NOISE_HIGH_VARIANCE(wd->noiseTh);
+}
+
+/*******************************************************************************
+* Function Name: ApplyNoiseConfiguration
+********************************************************************************
+* Summary:
+*  Scans Proximity0 with the quiet configuration in quiet conditions and with
+*  the configuration of design.cycapsense in noisy conditions. A change
+*  recalibrates only Proximity0, and its baseline and filters are initialized
+*  from the first scan of the new configuration. The scan time is measured
+*  again on the next frame. The quiet configuration is not used any more when
+*  its calibration fails. Parameters changed by the Tuner are kept. Called
+*  while no scan is in progress.
+*
+*******************************************************************************/
+static void ApplyNoiseConfiguration(void)
+{
+    bool quietConfig = (!noisyConditions) && quietConfigUsable;
+    cy_capsense_status_t status;
+
+    if (quietConfig == quietConfigActive)
+    {
+        return;
+    }
+
+    CaptureProximityConfiguration(quietConfigActive ? NOISE_QUIET_SUBCONV_SHIFT : 0u);
+    SetProximityConfiguration(quietConfig ? NOISE_QUIET_SUBCONV_SHIFT : 0u);
+    status = CalibrateProximity();
+
+    if ((CY_CAPSENSE_STATUS_SUCCESS != status) && quietConfig)
+    {
+        /* Back to the configuration of design.cycapsense */
+        quietConfigUsable = false;
+        quietConfig = false;
+        SetProximityConfiguration(0u);
+        (void)CalibrateProximity();
+    }
+
+    quietConfigActive = quietConfig;
+    proximityBaselinePending = true;
+
+    /* The variance follows the signal scale of the new configuration, the
+    * raw count of the last frame has the old one */
+    noiseVariance = quietConfig ? (noiseVariance >> (2u * NOISE_QUIET_SUBCONV_SHIFT)) :
+                                  NOISE_HIGH_VARIANCE(proximityNoisyConfig.noiseTh);
+    noiseLastRawValid = false;
+    noiseIdleFrameCount = 0u;
+
+#if ENABLE_TIMER_CALIBRATION
+    /* The scan time of the other configuration does not apply */
+    calibrationFrameCount = TIMER_CALIBRATION_INTERVAL;
+    calibrationSampleCount = 0u;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: CaptureProximityConfiguration
+********************************************************************************
+* Summary:
+*  Keeps the Proximity0 parameters changed by the Tuner since the last
+*  configuration change. A parameter of the widget context that differs from
+*  the stored one divided by 2^shift is stored multiplied by 2^shift.
+*
+* Parameters:
+*  shift: the shift of the configuration in use
+*
+*******************************************************************************/
+static void CaptureProximityConfiguration(uint32_t shift)
+{
+    const cy_stc_capsense_widget_context_t * wd = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID];
+    proximityConfig_t * config = &proximityNoisyConfig;
+
+    if (wd->numSubConversions != (config->numSubConversions >> shift))
+    {
+        config->numSubConversions = (uint16_t)(wd->numSubConversions << shift);
+    }
+    if (wd->fingerTh != (config->fingerTh >> shift))
+    {
+        config->fingerTh = (uint16_t)(wd->fingerTh << shift);
+    }
+    if (wd->proxTh != (config->proxTh >> shift))
+    {
+        config->proxTh = (uint16_t)(wd->proxTh << shift);
+    }
+    if (wd->noiseTh != (config->noiseTh >> shift))
+    {
+        config->noiseTh = (uint16_t)(wd->noiseTh << shift);
+    }
+    if (wd->nNoiseTh != (config->nNoiseTh >> shift))
+    {
+        config->nNoiseTh = (uint16_t)(wd->nNoiseTh << shift);
+    }
+    if (wd->hysteresis != (config->hysteresis >> shift))
+    {
+        config->hysteresis = (uint16_t)(wd->hysteresis << shift);
+    }
+}
+
+/*******************************************************************************
+* Function Name: CalibrateProximity
+********************************************************************************
+* Summary:
+*  Recalibrates the CDACs of Proximity0 for the configuration in its widget
+*  context. The other widgets keep their calibration and baselines.
+*
+* Return:
+*  status of Cy_CapSense_CalibrateWidget()
+*
+*******************************************************************************/
+static cy_capsense_status_t CalibrateProximity(void)
+{
+    return Cy_CapSense_CalibrateWidget(CY_CAPSENSE_PROXIMITY0_WDGT_ID, &cy_capsense_context);
+}
+
+/*******************************************************************************
+* Function Name: SetProximityConfiguration
+********************************************************************************
+* Summary:
+*  Writes the sub-conversions and thresholds of design.cycapsense divided by
+*  2^shift into the Proximity0 widget context.
+*
+* Parameters:
+*  shift: 0 for the configuration of design.cycapsense, or
+*  NOISE_QUIET_SUBCONV_SHIFT for the quiet configuration
+*
+*******************************************************************************/
+static void SetProximityConfiguration(uint32_t shift)
+{
+    cy_stc_capsense_widget_context_t * wd = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID];
+
+    wd->numSubConversions = (uint16_t)(proximityNoisyConfig.numSubConversions >> shift);
+    wd->fingerTh = (uint16_t)(proximityNoisyConfig.fingerTh >> shift);
+    wd->proxTh = (uint16_t)(proximityNoisyConfig.proxTh >> shift);
+    wd->noiseTh = (uint16_t)(proximityNoisyConfig.noiseTh >> shift);
+    wd->nNoiseTh = (uint16_t)(proximityNoisyConfig.nNoiseTh >> shift);
+    wd->hysteresis = (uint16_t)(proximityNoisyConfig.hysteresis >> shift);
+}
 #endif
 
-                Cy_CapSense_ProcessAllWidgets(&cy_capsense_context);
+/*******************************************************************************
+* Function Name: ProcessActiveFrame
+********************************************************************************
+* Summary:
+*  Processes the ACTIVE mode frame and adapts the refresh rate to the proximity
+*  signal. A transition to ALR mode overrides the adapted refresh rate.
+*
+* Return:
+*  true if any widget is active
+*
+*******************************************************************************/
+static bool ProcessActiveFrame(void)
+{
+    bool activity = ProcessFullFrame();
 
-                /* Scan, process and check the status of the all Active mode sensors */
-                if(Cy_CapSense_IsAnyWidgetActive(&cy_capsense_context))
-                {
-                    appState = ACTIVE_MODE;
-                    appStateTimeoutCount = TIMEOUT_RESET;
+#if ENABLE_TRANSITION_HYSTERESIS
+    /* Stay in ACTIVE mode until the diff falls below the lower threshold */
+    if (cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].diff >= GetTransitionDownDiff())
+    {
+        activity = true;
+    }
+#endif
 
-                    /* Configure the MSCLP wake up timer as per the ACTIVE mode refresh rate */
-                    Cy_CapSense_ConfigureMsclpTimer(ACTIVE_MODE_TIMER, &cy_capsense_context);
-                }
-                else
-                {
-                    appStateTimeoutCount++;
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+    UpdateAdaptiveRefreshRate();
+#endif
 
-                    if(ALR_MODE_TIMEOUT < appStateTimeoutCount)
-                    {
-                        appState = WOT_MODE;
-                        appStateTimeoutCount = TIMEOUT_RESET;
-                    }
-                }
+    return activity;
+}
 
-#if ENABLE_RUN_TIME_MEASUREMENT
-                alrModeRunTime = StopRuntimeMeasurement();
+/*******************************************************************************
+* Function Name: ProcessAlrFrame
+********************************************************************************
+* Summary:
+*  Processes the ALR mode frame. With the transition hysteresis a frame is
+*  active only when the proximity diff also reaches the upper threshold. Any
+*  widget activity makes the next ALR frame a full frame.
+*
+* Return:
+*  true if the frame is active
+*
+*******************************************************************************/
+static bool ProcessAlrFrame(void)
+{
+    bool activity = ProcessFullFrame();
+
+#if ENABLE_ALR_SENTINEL
+    if (activity)
+    {
+        sentinelFramesLeft = 0u;
+    }
+    else if (!sentinelFrame)
+    {
+        sentinelFramesLeft = ALR_SENTINEL_FULL_FRAME_DIVIDER - 1u;
+    }
+    else if (0u != sentinelFramesLeft)
+    {
+        /* Checked, as the pipelined scan arms the next frame before this
+        * frame is processed */
+        sentinelFramesLeft--;
+    }
+    else
+    {
+        /* The full frame is already armed */
+    }
+#endif
+
+#if ENABLE_TRANSITION_HYSTERESIS
+    if (cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].diff < GetTransitionUpDiff())
+    {
+        activity = false;
+    }
 #endif
-                break;
-                /* End of Active-Low Refresh Rate(ALR) mode */
 
-            /* Wake On Touch Mode */
-            case WOT_MODE :
+    return activity;
+}
+
+/*******************************************************************************
+* Function Name: ProcessLpFrame
+********************************************************************************
+* Summary:
+*  Processes only the Low Power widgets to detect touch.
+*
+* Return:
+*  true if any low power widget is active
+*
+*******************************************************************************/
+static bool ProcessLpFrame(void)
+{
+    bool activity;
 
-                /* Trigger the low power widget scan */
-                Cy_CapSense_ScanAllLpSlots(&cy_capsense_context);
+    PROFILER_START(PROFILER_STAGE_WOT_PROCESS);
+    Cy_CapSense_ProcessWidget(CY_CAPSENSE_LOWPOWER0_WDGT_ID, &cy_capsense_context);
+    activity = (0u != Cy_CapSense_IsAnyLpWidgetActive(&cy_capsense_context));
+    PROFILER_STOP(PROFILER_STAGE_WOT_PROCESS);
 
-                while (Cy_CapSense_IsBusy(&cy_capsense_context))
-                {
-                    /* Enter and stay in Deep Sleep until WOT timeout or a touch is detected. */
-                    /* WOT Timeout = WOT scan interval x Num of frames in WOT (in uSec); 
-                    * Refer to Wake-On-Touch settings in CAPSENSE Configurator for WOT Timeout*/
+#if ENABLE_WOT_FAST_WAKE
+    /* The LED and telemetry of this frame show the low power widget status,
+    * without waiting for the first ACTIVE mode frame */
+    wotWakeFrame = activity;
+#endif
+
+#if ENABLE_WOT_AUTO_INTERVAL
+    UpdateWotInterval(activity);
+#endif
+
+    return activity;
+}
 
-                    Cy_SysPm_CpuEnterDeepSleep ();
-                }
+#if ENABLE_WOT_AUTO_INTERVAL
+/*******************************************************************************
+* Function Name: InitWotInterval
+********************************************************************************
+* Summary:
+*  Reads the number of frames in WOT of the CAPSENSE configuration and finds the
+*  most WOT scan interval doublings within WOT_SCAN_INTERVAL_MAX_US.
+*
+*******************************************************************************/
+static void InitWotInterval(void)
+{
+    /* The configured WOT scan interval alone must meet the latency */
+    CY_ASSERT(wotScanIntervalConfig <= WOT_SCAN_INTERVAL_MAX_US);
 
-                /* Process only the Low Power widgets to detect touch */
-                Cy_CapSense_ProcessWidget(CY_CAPSENSE_LOWPOWER0_WDGT_ID, &cy_capsense_context);
+    wotTimeoutFrames = cy_capsense_context.ptrInternalContext->wotTimeout;
+    wotIntervalLevelMax = 0u;
 
-                if (Cy_CapSense_IsAnyLpWidgetActive(&cy_capsense_context))
-                {
-                    appState = ACTIVE_MODE;
-                    appStateTimeoutCount = TIMEOUT_RESET;
+    while ((wotIntervalLevelMax < (WOT_INTERVAL_LEVEL_NUM - 1u)) &&
+           ((wotScanIntervalConfig << (wotIntervalLevelMax + 1u)) <= WOT_SCAN_INTERVAL_MAX_US))
+    {
+        wotIntervalLevelMax++;
+    }
+}
 
-                    /* Configure the MSCLP wake up timer as per the ACTIVE mode refresh rate */
-                    Cy_CapSense_ConfigureMsclpTimer(ACTIVE_MODE_TIMER, &cy_capsense_context);
-                }
+/*******************************************************************************
+* Function Name: SetWotIntervalLevel
+********************************************************************************
+* Summary:
+*  Requests the WOT scan interval of the CAPSENSE configuration doubled level
+*  times, configured by ConfigureWotInterval() before the next WOT frame.
+*
+* Parameters:
+*  level: number of WOT scan interval doublings
+*
+*******************************************************************************/
+static void SetWotIntervalLevel(uint32_t level)
+{
+    wotIntervalTarget = level;
+    wotIntervalCycleCount = 0u;
+    wotIntervalPending = true;
+}
 
-                else
-                {
-                    appState = ALR_MODE;
-                    appStateTimeoutCount = TIMEOUT_RESET;
+/*******************************************************************************
+* Function Name: ConfigureWotInterval
+********************************************************************************
+* Summary:
+*  Configures the requested WOT scan interval and the number of frames in WOT,
+*  halved with every doubling. Called with the MSCLP idle. On failure the
+*  configured interval is kept and the request is retried before the next WOT
+*  frame.
+*
+*******************************************************************************/
+static void ConfigureWotInterval(void)
+{
+    uint32_t frames = wotTimeoutFrames >> wotIntervalTarget;
 
-                    /* Configure the MSCLP wake up timer as per the ALR mode refresh rate */
-                    Cy_CapSense_ConfigureMsclpTimer(ALR_MODE_TIMER, &cy_capsense_context);
-                }
-                break;
-                /* End of "WAKE_ON_TOUCH_MODE" */
+    if (wotIntervalPending &&
+        (CY_CAPSENSE_STATUS_SUCCESS == Cy_CapSense_ConfigureMsclpWotTimer(wotScanIntervalConfig << wotIntervalTarget,
+                                                                          &cy_capsense_context)))
+    {
+        wotIntervalLevel = wotIntervalTarget;
+        wotIntervalPending = false;
+        cy_capsense_context.ptrInternalContext->wotTimeout = (uint16_t)((0u != frames) ? frames : 1u);
+    }
+}
 
-            default:
-                /** Unknown power mode state. Unexpected situation. **/
-                CY_ASSERT(CY_ASSERT_FAILED);
-                break;
+/*******************************************************************************
+* Function Name: UpdateWotInterval
+********************************************************************************
+* Summary:
+*  Counts the WOT timeouts without activity and lengthens the WOT scan interval
+*  after WOT_INTERVAL_STEP_CYCLES of them. Activity restores the short interval.
+*
+* Parameters:
+*  activity: the low power widget status of the WOT frame
+*
+*******************************************************************************/
+static void UpdateWotInterval(bool activity)
+{
+    if (activity)
+    {
+        if (0u != wotIntervalTarget)
+        {
+            SetWotIntervalLevel(0u);
         }
+        wotIntervalCycleCount = 0u;
+    }
+    else if (wotIntervalTarget < wotIntervalLevelMax)
+    {
+        wotIntervalCycleCount++;
 
-#if ENABLE_SPI_SERIAL_LED
-        /* Refresh LEDs to show latest status */
-        UpdateLeds();
+        if (wotIntervalCycleCount >= WOT_INTERVAL_STEP_CYCLES)
+        {
+            SetWotIntervalLevel(wotIntervalTarget + 1u);
+        }
+    }
+    else
+    {
+        /* Longest WOT scan interval, until the next activity */
+    }
+}
 #endif
 
-#if ENABLE_TUNER
-        /* Establishes synchronized communication with the CAPSENSE&trade; Tuner tool */
-        Cy_CapSense_RunTuner(&cy_capsense_context);
-#endif
+#if ENABLE_WOT_DIRECT_REARM
+/*******************************************************************************
+* Function Name: SelectWotIdleState
+********************************************************************************
+* Summary:
+*  Selects the state after a WOT timeout without activity. The first
+*  WOT_DIRECT_REARM_CYCLES timeouts move to ALR mode, afterwards the WOT scan
+*  is re-armed directly with a baseline refresh burst every
+*  WOT_BASELINE_REFRESH_CYCLES cycles.
+*
+* Return:
+*  ALR_MODE, WOT_MODE or BASELINE_MODE
+*
+*******************************************************************************/
+static APPLICATION_STATE SelectWotIdleState(void)
+{
+    if (wotIdleCycleCount < WOT_DIRECT_REARM_CYCLES)
+    {
+        wotIdleCycleCount++;
+        return ALR_MODE;
+    }
 
+    wotBaselineCycleCount++;
+
+    if (wotBaselineCycleCount >= WOT_BASELINE_REFRESH_CYCLES)
+    {
+        wotBaselineCycleCount = 0u;
+        return BASELINE_MODE;
     }
+
+    return WOT_MODE;
 }
+#endif
 
 /*******************************************************************************
 * Function Name: InitializeCapsense
@@ -519,25 +2408,188 @@ static void InitializeCapsense(void)
         status = Cy_CapSense_Enable(&cy_capsense_context);
     }
 
-    if (status != CY_CAPSENSE_STATUS_SUCCESS)
+    if (status != CY_CAPSENSE_STATUS_SUCCESS)
+    {
+        /* This status could fail before tuning the sensors correctly.
+         * Ensure that this function passes after the CAPSENSE sensors are tuned
+         * as per procedure give in the Readme.md file */
+    }
+}
+
+/*******************************************************************************
+* Function Name: Capsense_Msc0Isr
+********************************************************************************
+* Summary:
+*  Wrapper function for handling interrupts from CAPSENSE MSC0 block. Posts
+*  APP_EVENT_SCAN_DONE on the interrupt that completes the scan.
+*
+*******************************************************************************/
+static void Capsense_Msc0Isr(void)
+{
+    Cy_CapSense_InterruptHandler(CY_MSCLP0_HW, &cy_capsense_context);
+
+    if (CY_CAPSENSE_NOT_BUSY == Cy_CapSense_IsBusy(&cy_capsense_context))
+    {
+#if ENABLE_OVERRUN_MONITOR
+        scanDoneTicks = Cy_SysTick_GetValue();
+#endif
+        MARKER_TOGGLE(SCAN_DONE);
+        PostAppEvent(APP_EVENT_SCAN_DONE);
+    }
+}
+
+/*******************************************************************************
+* Function Name: PostAppEvent
+********************************************************************************
+* Summary:
+*  Sets event bits for the main loop. Called from the interrupts, the update
+*  is done in a critical section as the interrupts have different priorities.
+*
+* Parameters:
+*  events: APP_EVENT_* bits to set
+*
+*******************************************************************************/
+static void PostAppEvent(uint32_t events)
+{
+    uint32_t interruptStatus = Cy_SysLib_EnterCriticalSection();
+
+    appEvents |= events;
+
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+}
+
+/*******************************************************************************
+* Function Name: TakeAppEvents
+********************************************************************************
+* Summary:
+*  Reads and clears event bits.
+*
+* Parameters:
+*  events: APP_EVENT_* bits to read and clear
+*
+* Return:
+*  the bits of events that were set
+*
+*******************************************************************************/
+static uint32_t TakeAppEvents(uint32_t events)
+{
+    uint32_t interruptStatus = Cy_SysLib_EnterCriticalSection();
+    uint32_t pending = appEvents & events;
+
+    appEvents &= ~events;
+
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+
+    return pending;
+}
+
+/*******************************************************************************
+* Function Name: SetRefreshRateLevel
+********************************************************************************
+* Summary:
+*  Configures the MSCLP wake up timer and the overrun budget as per the refresh
+*  rate level. While the pipelined scan has the next frame armed, the timer is
+*  configured before the frame after it is started.
+*
+* Parameters:
+*  level: refresh rate level, REFRESH_RATE_LEVEL_ACTIVE to REFRESH_RATE_LEVEL_ALR
+*
+*******************************************************************************/
+static void SetRefreshRateLevel(uint32_t level)
+{
+#if ENABLE_OVERRUN_MONITOR
+    uint32_t busyTime;
+    uint32_t budgetTime;
+#endif
+
+    refreshRateLevel = level;
+
+#if ENABLE_PIPELINED_SCAN
+    if (nextScanArmed)
+    {
+        /* The middleware is busy with the armed frame */
+        refreshRateTimerPending = true;
+    }
+    else
+#endif
+    {
+        ConfigureRefreshRateTimer();
+    }
+
+#if ENABLE_OVERRUN_MONITOR
+    /* Frame period not covered by the MSCLP timer and the scan. The timer
+    * calibration measures a typical pass, so the budget is at least the
+    * estimate with the LED and Tuner work */
+    busyTime = refreshRateTimer[level] + OVERRUN_SCAN_TIME;
+    budgetTime = (refreshRatePeriod[level] > busyTime) ? (refreshRatePeriod[level] - busyTime) : 0u;
+    if (budgetTime < ACTIVE_MODE_PROCESS_TIME)
     {
-        /* This status could fail before tuning the sensors correctly.
-         * Ensure that this function passes after the CAPSENSE sensors are tuned
-         * as per procedure give in the Readme.md file */
+        budgetTime = ACTIVE_MODE_PROCESS_TIME;
     }
+    frameBudgetTicks = (budgetTime + OVERRUN_TOLERANCE_US) * TICKS_PER_US;
+#endif
 }
 
 /*******************************************************************************
-* Function Name: Capsense_Msc0Isr
+* Function Name: ConfigureRefreshRateTimer
 ********************************************************************************
 * Summary:
-*  Wrapper function for handling interrupts from CAPSENSE MSC0 block.
+*  Configures the MSCLP wake up timer of the current refresh rate level. Called
+*  while no scan is in progress; a rejected timer stays pending and is
+*  configured again before the next frame scan is started.
 *
 *******************************************************************************/
-static void Capsense_Msc0Isr(void)
+static void ConfigureRefreshRateTimer(void)
 {
-    Cy_CapSense_InterruptHandler(CY_MSCLP0_HW, &cy_capsense_context);
+    refreshRateTimerPending = (CY_CAPSENSE_STATUS_SUCCESS !=
+                               Cy_CapSense_ConfigureMsclpTimer(refreshRateTimer[refreshRateLevel],
+                                                               &cy_capsense_context));
+}
+
+#if ENABLE_ADAPTIVE_REFRESH_RATE
+/*******************************************************************************
+* Function Name: UpdateAdaptiveRefreshRate
+********************************************************************************
+* Summary:
+*  Selects the refresh rate level in ACTIVE mode from the proximity diff trend.
+*  A diff rise of ADAPTIVE_REFRESH_APPROACH_DIFF or more in one frame moves to
+*  the highest refresh rate; otherwise the refresh rate moves one level down
+*  every ADAPTIVE_REFRESH_DECAY_FRAMES frames. The timer is reconfigured only
+*  when the level changes.
+*
+*******************************************************************************/
+static void UpdateAdaptiveRefreshRate(void)
+{
+    static uint32_t prevProxDiff = 0u;
+    static uint32_t decayFrameCount = 0u;
+
+    uint32_t proxDiff = cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].diff;
+    uint32_t level = refreshRateLevel;
+
+    if (proxDiff >= (prevProxDiff + ADAPTIVE_REFRESH_APPROACH_DIFF))
+    {
+        level = REFRESH_RATE_LEVEL_ACTIVE;
+        decayFrameCount = 0u;
+    }
+    else
+    {
+        decayFrameCount++;
+
+        if ((ADAPTIVE_REFRESH_DECAY_FRAMES <= decayFrameCount) && (REFRESH_RATE_LEVEL_ALR > level))
+        {
+            level++;
+            decayFrameCount = 0u;
+        }
+    }
+
+    prevProxDiff = proxDiff;
+
+    if (level != refreshRateLevel)
+    {
+        SetRefreshRateLevel(level);
+    }
 }
+#endif
 
 /*******************************************************************************
 * Function Name: InitializeCapsenseTuner
@@ -577,6 +2629,14 @@ static void InitializeCapsenseTuner(void)
                             sizeof(cy_capsense_tuner), sizeof(cy_capsense_tuner),
                             &ezi2cContext);
 
+#if ENABLE_TELEMETRY
+    /* Set the read-only host interface (telemetry and diagnostic data) as the
+     * I2C buffer exposed on the secondary slave address. A host polling the
+     * status reads only the telemetry at the start of the buffer */
+    Cy_SCB_EZI2C_SetBuffer2(CYBSP_EZI2C_HW, (uint8_t *)&hostInterface,
+                            sizeof(hostInterface), 0u, &ezi2cContext);
+#endif
+
     Cy_SCB_EZI2C_Enable(CYBSP_EZI2C_HW);
 }
 
@@ -589,8 +2649,69 @@ static void InitializeCapsenseTuner(void)
 *******************************************************************************/
 static void Ezi2cIsr(void)
 {
+    uint32_t activity;
+
     Cy_SCB_EZI2C_Interrupt(CYBSP_EZI2C_HW, &ezi2cContext);
+
+    /* The host access is kept until the main loop handles it */
+    activity = Cy_SCB_EZI2C_GetActivity(CYBSP_EZI2C_HW, &ezi2cContext);
+    if (0u != (activity & (CY_SCB_EZI2C_STATUS_READ1 | CY_SCB_EZI2C_STATUS_WRITE1)))
+    {
+        PostAppEvent(APP_EVENT_HOST_ACCESS);
+    }
+#if ENABLE_BATCHED_REPORT
+    if (0u != (activity & CY_SCB_EZI2C_STATUS_READ2))
+    {
+        PostAppEvent(APP_EVENT_HOST_READ);
+    }
+#endif
+
+#if ENABLE_ENERGY_ACCOUNTING
+    /* The transaction is active from the address match until the stop condition */
+    if (0u != (activity & CY_SCB_EZI2C_STATUS_BUSY))
+    {
+        EnergyCommStart(ENERGY_COMM_I2C);
+    }
+    else
+    {
+        EnergyCommStop(ENERGY_COMM_I2C);
+    }
+#endif
+}
+
+#if (ENABLE_TUNER && ENABLE_TUNER_ON_DEMAND)
+/*******************************************************************************
+* Function Name: IsTunerServiceDue
+********************************************************************************
+* Summary:
+* Checks whether the Tuner is to be run on this main loop pass: the host read
+* or wrote the Tuner buffer (primary slave address) since the last check, or
+* TUNER_SERVICE_DIVIDER passes went by without a Tuner run.
+*
+* Return:
+*  true when Cy_CapSense_RunTuner() is to be called
+*
+*******************************************************************************/
+static bool IsTunerServiceDue(void)
+{
+    static uint32_t tunerServiceCount = 0u;
+
+    bool hostAccess;
+    bool serviceDue = false;
+
+    hostAccess = (0u != TakeAppEvents(APP_EVENT_HOST_ACCESS));
+
+    tunerServiceCount++;
+
+    if ((hostAccess) || (TUNER_SERVICE_DIVIDER <= tunerServiceCount))
+    {
+        tunerServiceCount = 0u;
+        serviceDue = true;
+    }
+
+    return serviceDue;
 }
+#endif
 
 /*******************************************************************************
 * Function Name: RegisterCallback
@@ -625,7 +2746,8 @@ void RegisterCallback(void)
 ********************************************************************************
 *
 * Summary:
-* Deep Sleep callback implementation. Waits for the completion of SPI transaction.
+* Deep Sleep callback implementation. Refuses Deep Sleep until the SPI transaction
+* started by ProcessSerialLed() is complete.
 * And change the SPI GPIOs to highZ while transition to deep-sleep and vice-versa
 *
 * Parameters:
@@ -646,6 +2768,14 @@ cy_en_syspm_status_t DeepSleepCallback(
         case CY_SYSPM_CHECK_READY:
 
             retValue = CY_SYSPM_SUCCESS;
+
+            #if ENABLE_SPI_SERIAL_LED
+            /* Do not enter Deep Sleep in the middle of a LED frame */
+            if (IsSpiTransferActive())
+            {
+                retValue = CY_SYSPM_FAIL;
+            }
+            #endif
             break;
 
         case CY_SYSPM_CHECK_FAIL:
@@ -660,11 +2790,17 @@ cy_en_syspm_status_t DeepSleepCallback(
             Cy_GPIO_SetDrivemode(CYBSP_SPI_MOSI_PORT, CYBSP_SPI_MOSI_PIN, CY_GPIO_DM_ANALOG);
             #endif
 
+            /* Last callback before the CPU enters Deep Sleep */
+            ENERGY_SET_DOMAIN(ENERGY_DOMAIN_DEEP_SLEEP);
+
             retValue = CY_SYSPM_SUCCESS;
             break;
 
         case CY_SYSPM_AFTER_TRANSITION:
 
+            /* First callback after the wake up */
+            ENERGY_SET_DOMAIN(ENERGY_DOMAIN_CPU_ACTIVE);
+
             #if ENABLE_SPI_SERIAL_LED
             /* SPI pins drive mode to Strong */
             Cy_GPIO_SetDrivemode(CYBSP_SPI_MOSI_PORT, CYBSP_SPI_MOSI_PIN, CY_GPIO_DM_STRONG_IN_OFF);
@@ -681,23 +2817,59 @@ cy_en_syspm_status_t DeepSleepCallback(
     return retValue;
 }
 
+#if (ENABLE_RUN_TIME_MEASUREMENT || ENABLE_TIMER_CALIBRATION || ENABLE_OVERRUN_MONITOR)
+/*******************************************************************************
+* Function Name: GetElapsedTicks
+********************************************************************************
+* Summary:
+*  Reads the system tick elapsed since a captured SysTick value.
+*
+*  Parameters:
+*  startTicks - SysTick value at the start of the measurement
+*
+*  Returns:
+*  ticks - in CPU clock cycles
+*******************************************************************************/
+static uint32_t GetElapsedTicks(uint32_t startTicks)
+{
+    /* SysTick counts down and wraps at 24 bits */
+    return ((startTicks - Cy_SysTick_GetValue()) & SYS_TICK_MAX_INTERVAL);
+}
+#endif
+
 #if ENABLE_RUN_TIME_MEASUREMENT
 /*******************************************************************************
 * Function Name: StartRuntimeMeasurement
 ********************************************************************************
 * Summary:
-*  Initializes the system tick counter by calling Cy_SysTick_Clear() API.
+*  Stores the system tick counter value at the start of the measurement. The
+*  counter is not cleared, so the profiler can measure other stages meanwhile.
 *******************************************************************************/
 static void StartRuntimeMeasurement()
 {
-    Cy_SysTick_Clear();
+    runtimeStartTicks = Cy_SysTick_GetValue();
+}
+
+/*******************************************************************************
+* Function Name: GetRuntimeTicks
+********************************************************************************
+* Summary:
+*  Reads the system tick elapsed since StartRuntimeMeasurement().
+*
+*  Returns:
+*  ticks - in CPU clock cycles
+*******************************************************************************/
+static uint32_t GetRuntimeTicks()
+{
+    return GetElapsedTicks(runtimeStartTicks);
 }
 
 /*******************************************************************************
 * Function Name: StopRuntimeMeasurement
 ********************************************************************************
 * Summary:
-*  Reads the system tick and converts to time in microseconds(us).
+*  Reads the system tick and converts to time in microseconds(us) with an
+*  integer division, avoiding the software floating point library.
 *
 *  Returns:
 *  runTime - in microseconds(us)
@@ -707,13 +2879,261 @@ static uint32_t StopRuntimeMeasurement()
 {
     uint32_t ticks;
     uint32_t runTime;
-    ticks = Cy_SysTick_GetValue();
-    ticks = (SYS_TICK_MAX_INTERVAL - Cy_SysTick_GetValue());
-    runTime = (ticks * TIME_PER_TICK_IN_US);
+    ticks = GetRuntimeTicks();
+    runTime = (ticks / TICKS_PER_US);
     return runTime;
 }
 #endif
 
+#if ENABLE_LED_BENCHMARK
+/*******************************************************************************
+* Function Name: RunLedBenchmark
+********************************************************************************
+* Summary:
+*  Encodes LED_BENCHMARK_FRAMES LED patterns with EncodeSerialLed(), the same
+*  patterns on every build, measures the CPU cycles of each frame and checks
+*  each frame with IsLedBenchmarkFrameValid(). Comparing ledBenchmark* between
+*  two builds in a debug session shows whether a change made the encoder slower
+*  or changed its output. Asserts when a frame is wrong, CY_ASSERT() stops only
+*  Debug builds.
+*
+*******************************************************************************/
+static void RunLedBenchmark(void)
+{
+    serialLedContext_t pattern;
+    uint8_t * colorData = (uint8_t *)pattern.serialLedData;
+    uint32_t totalCycles = 0u;
+    uint32_t maxCycles = 0u;
+    uint32_t frame;
+    uint32_t i;
+
+    for (frame = 0u; frame < LED_BENCHMARK_FRAMES; frame++)
+    {
+        uint32_t cycles;
+
+        /* All colors off, all full and mixed bit patterns in between */
+        for (i = 0u; i < sizeof(pattern.serialLedData); i++)
+        {
+            colorData[i] = (0u == frame) ? 0x00u :
+                           ((LED_BENCHMARK_FRAMES - 1u) == frame) ? 0xFFu :
+                           (uint8_t)((i * 0x1Du) ^ (frame * 0x35u));
+        }
+
+        StartRuntimeMeasurement();
+        EncodeSerialLed(&pattern);
+        cycles = GetRuntimeTicks();
+
+        totalCycles += cycles;
+        if (cycles > maxCycles)
+        {
+            maxCycles = cycles;
+        }
+
+        if (!IsLedBenchmarkFrameValid(&pattern))
+        {
+            ledBenchmarkErrors++;
+        }
+    }
+
+    ledBenchmarkAvgCycles = totalCycles / LED_BENCHMARK_FRAMES;
+    ledBenchmarkMaxCycles = maxCycles;
+    ledBenchmarkOverBudget = (maxCycles > (SERIAL_LED_PROCESS_TIME * TICKS_PER_US));
+
+    CY_ASSERT(0u == ledBenchmarkErrors);
+}
+
+/*******************************************************************************
+* Function Name: IsLedBenchmarkFrameValid
+********************************************************************************
+* Summary:
+*  Checks ledTxBuffer against the LED frame encoded one bit at a time: the
+*  reset bytes are 0 and each color bit, MSB first, is the LED_STATE_ON or
+*  LED_STATE_OFF pattern of TX_BITS_PER_LED_COLOR_BIT SPI bits, read one SPI
+*  bit at a time with the first one in the MSB of each byte.
+*
+*  Parameters:
+*  ptr_ledContext - LED data encoded into ledTxBuffer
+*
+*  Returns:
+*  true when ledTxBuffer holds the expected frame
+*******************************************************************************/
+static bool IsLedBenchmarkFrameValid(const serialLedContext_t * ptr_ledContext)
+{
+    const uint8_t * colorData = (const uint8_t *)ptr_ledContext->serialLedData;
+    uint32_t bitIndex;
+    uint32_t txBit;
+    uint32_t pattern;
+    uint32_t i;
+
+    for (i = 0u; i < LED_RESET_BYTES; i++)
+    {
+        if (0u != ledTxBuffer[i])
+        {
+            return false;
+        }
+    }
+
+    for (bitIndex = 0u; bitIndex < (NUM_OF_LEDS * NUM_OF_LED_COLORS * NUM_OF_BITS_PER_COLOR); bitIndex++)
+    {
+        uint32_t color = colorData[bitIndex / NUM_OF_BITS_PER_COLOR];
+        uint32_t bit = (color >> ((NUM_OF_BITS_PER_COLOR - 1u) - (bitIndex % NUM_OF_BITS_PER_COLOR))) & 1u;
+
+        pattern = 0u;
+        for (i = 0u; i < TX_BITS_PER_LED_COLOR_BIT; i++)
+        {
+            txBit = (bitIndex * TX_BITS_PER_LED_COLOR_BIT) + i;
+            pattern = (pattern << 1u) |
+                      ((uint32_t)(ledTxBuffer[LED_RESET_BYTES + (txBit / 8u)] >> (7u - (txBit % 8u))) & 1u);
+        }
+
+        if (pattern != ((0u != bit) ? LED_STATE_ON : LED_STATE_OFF))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+#if ENABLE_TIMER_CALIBRATION
+/*******************************************************************************
+* Function Name: IsTimerCalibrationDue
+********************************************************************************
+* Summary:
+*  Checks whether the next full scan frame is to be measured.
+*
+*  Returns:
+*  true when TIMER_CALIBRATION_INTERVAL frames passed since the last calibration
+*******************************************************************************/
+static bool IsTimerCalibrationDue(void)
+{
+    return (TIMER_CALIBRATION_INTERVAL <= calibrationFrameCount);
+}
+
+/*******************************************************************************
+* Function Name: StartScanTimeCalibration
+********************************************************************************
+* Summary:
+*  Starts measuring the frame when the calibration is due. Called right before
+*  Cy_CapSense_ScanAllSlots().
+*******************************************************************************/
+static void StartScanTimeCalibration(void)
+{
+    if (IsTimerCalibrationDue())
+    {
+        calibrationActive = true;
+        calibrationTimer = refreshRateTimer[refreshRateLevel];
+        calibrationStartTicks = Cy_SysTick_GetValue();
+    }
+}
+
+/*******************************************************************************
+* Function Name: StopScanTimeCalibration
+********************************************************************************
+* Summary:
+*  Captures the scan ticks of the measured frame, which include the MSCLP timer,
+*  and starts measuring the processing. Called when the scan is complete.
+*******************************************************************************/
+static void StopScanTimeCalibration(void)
+{
+    if (calibrationActive)
+    {
+        calibrationScanTicks = GetElapsedTicks(calibrationStartTicks);
+        calibrationStartTicks = Cy_SysTick_GetValue();
+    }
+}
+
+/*******************************************************************************
+* Function Name: FinishTimerCalibration
+********************************************************************************
+* Summary:
+*  Called at the end of each main loop pass. For a measured frame, converts the
+*  scan and process ticks to microseconds and recomputes the MSCLP timer of all
+*  refresh rate levels from the longest busy time of the last
+*  TIMER_CALIBRATION_WINDOW measured frames plus the Deep Sleep wake up time,
+*  so that no frame period exceeds the refresh rate period. Measurements longer
+*  than the ACTIVE mode frame period (e.g. the Tuner held the loop) are
+*  discarded.
+*******************************************************************************/
+static void FinishTimerCalibration(void)
+{
+    uint32_t scanTime;
+    uint32_t processTime;
+    uint32_t busyTime;
+    uint32_t level;
+    uint32_t sample;
+    uint32_t index;
+
+    if (!calibrationActive)
+    {
+        if (!IsTimerCalibrationDue())
+        {
+            calibrationFrameCount++;
+        }
+        return;
+    }
+
+    calibrationActive = false;
+    calibrationFrameCount = 0u;
+
+    processTime = GetElapsedTicks(calibrationStartTicks) / TICKS_PER_US;
+    scanTime = calibrationScanTicks / TICKS_PER_US;
+
+    /* Remove the MSCLP timer from the measured scan time */
+    scanTime = (scanTime > calibrationTimer) ? (scanTime - calibrationTimer) : 0u;
+
+    if ((scanTime + processTime) >= refreshRatePeriod[REFRESH_RATE_LEVEL_ACTIVE])
+    {
+        return;
+    }
+
+    measuredScanTime = scanTime;
+    measuredProcessTime = processTime;
+
+#if ENABLE_TELEMETRY
+    SetTelemetryTiming(scanTime, processTime);
+#endif
+
+#if ENABLE_PIPELINED_SCAN
+    /* Processing overlaps the MSCLP timer of the next frame */
+    calibrationBusyTime[calibrationSampleIndex] = scanTime;
+#else
+    calibrationBusyTime[calibrationSampleIndex] = scanTime + processTime;
+#endif
+
+    calibrationSampleIndex = (calibrationSampleIndex + 1u) % TIMER_CALIBRATION_WINDOW;
+    if (calibrationSampleCount < TIMER_CALIBRATION_WINDOW)
+    {
+        calibrationSampleCount++;
+    }
+
+    busyTime = 0u;
+    for (sample = 0u; sample < calibrationSampleCount; sample++)
+    {
+        /* The newest samples are the last calibrationSampleCount entries
+        * before calibrationSampleIndex */
+        index = (calibrationSampleIndex + TIMER_CALIBRATION_WINDOW - 1u - sample) %
+                TIMER_CALIBRATION_WINDOW;
+        if (busyTime < calibrationBusyTime[index])
+        {
+            busyTime = calibrationBusyTime[index];
+        }
+    }
+
+    /* The measured frame woke up from CPU Sleep, the others from Deep Sleep */
+    busyTime += DEEP_SLEEP_WAKEUP_US;
+
+    for (level = 0u; level < REFRESH_RATE_LEVEL_NUM; level++)
+    {
+        refreshRateTimer[level] = (refreshRatePeriod[level] > (busyTime + MINIMUM_TIMER)) ?
+                                    (refreshRatePeriod[level] - busyTime) : MINIMUM_TIMER;
+    }
+
+    SetRefreshRateLevel(refreshRateLevel);
+}
+#endif
+
 #if ENABLE_SPI_SERIAL_LED
 /*******************************************************************************
 * Function Name: UpdateLeds
@@ -732,8 +3152,6 @@ void UpdateLeds(void)
     * brightness of an LED
     */
     uint8_t proxLedBrightness = 0u;
-    uint16_t proxMaxRawCount = 0u;
-    uint16_t maxDiffCount = 0u;
 
     uint32_t proxSensorStatus = Cy_CapSense_IsProximitySensorActive(CY_CAPSENSE_PROXIMITY0_WDGT_ID, CY_CAPSENSE_PROXIMITY0_SNS0_ID, &cy_capsense_context);
 
@@ -743,12 +3161,19 @@ void UpdateLeds(void)
 
     /* LED1 and LED2 Control: Check the status of Active mode sensors (proximity sensor) and control LED1 and LED2 accordingly */
 
+#if ENABLE_WOT_FAST_WAKE
+        if (wotWakeFrame)
+        {
+            /* The proximity sensor is not processed yet after the wake up,
+            * LED1 (GREEN) shows the low power widget detection */
+            ledContext.serialLedData[LED1].green = WOT_WAKE_LED_BRIGHTNESS;
+        }
+        else
+#endif
         if(proxSensorStatus == PROX_STATE)
         {
             /* Calculate proximity status LED brightness based on target object/hand distance from sensor */
-            proxMaxRawCount = cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID].maxRawCount;
-            maxDiffCount = proxMaxRawCount - cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].bsln;
-            proxLedBrightness = (uint8_t)((uint32_t)(cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].diff*255)/maxDiffCount);
+            proxLedBrightness = GetProxLedBrightness();
 
             /* LED1 (GREEN) Turns on when proximity is detected */
             ledContext.serialLedData[LED1].green = proxLedBrightness;
@@ -762,7 +3187,133 @@ void UpdateLeds(void)
             ledContext.serialLedData[LED1].blue = SERIAL_LED_BRIGHTNESS_MAX;
         }
 
+#if ENABLE_LED_ANIMATION
+    {
+        static ledData_t fadeTarget = {0u, 0u, 0u};
+        ledData_t * led1 = &ledContext.serialLedData[LED1];
+
+        /* A new status color starts a fade from the color shown. A proximity
+        * distance changing every frame makes LED1 follow it smoothly */
+        if ((fadeTarget.red != led1->red) || (fadeTarget.green != led1->green) || (fadeTarget.blue != led1->blue))
+        {
+            fadeTarget = *led1;
+            StartLedFade(LED1, &fadeTarget, LED_FADE_FRAMES);
+        }
+
+        (void)StepLedAnimation(&ledContext, GetLedAnimationSteps());
+    }
+#endif
+
+#if ENABLE_LED_BAR_GRAPH
+    {
+        ledData_t barColor =
+        {
+            .red    = 0u,
+            .green  = (0u != ledContext.serialLedData[LED1].green) ? SERIAL_LED_BRIGHTNESS_MAX : 0u,
+            .blue   = (0u != ledContext.serialLedData[LED1].blue) ? SERIAL_LED_BRIGHTNESS_MAX : 0u
+        };
+
+        /* LED1 brightness is the bar length, touch shows a full bar */
+        SetSerialLedBarGraph(&ledContext,
+                             (ledContext.serialLedData[LED1].green > ledContext.serialLedData[LED1].blue) ?
+                             ledContext.serialLedData[LED1].green : ledContext.serialLedData[LED1].blue,
+                             &barColor);
+    }
+#endif
+
+#if (ENABLE_RUN_TIME_MEASUREMENT && (SERIAL_LED_TX_MODE == SERIAL_LED_TX_FULL))
+    /* Measure the LED frame encoder alone, without the SPI transfer */
+    StartRuntimeMeasurement();
+    EncodeSerialLed(&ledContext);
+    ledEncodeCycles = GetRuntimeTicks();
+#endif
+
+    PROFILER_START(PROFILER_STAGE_PROCESS_SERIAL_LED);
     ProcessSerialLed(&ledContext);
+    PROFILER_STOP(PROFILER_STAGE_PROCESS_SERIAL_LED);
+}
+
+#if ENABLE_LED_ANIMATION
+/*******************************************************************************
+* Function Name: GetLedAnimationSteps
+********************************************************************************
+* Summary:
+*  Returns the LED animation steps of the frame just completed, the number of
+*  ACTIVE mode frames that fit in the current frame period. The fraction left
+*  by the adaptive refresh rate levels is carried over to the next frame.
+*
+*  Returns:
+*  LED animation steps
+*******************************************************************************/
+static uint32_t GetLedAnimationSteps(void)
+{
+    uint32_t steps;
+
+    if (WOT_MODE == appState)
+    {
+        return WOT_MODE_ANIMATION_FRAMES;
+    }
+
+    ledAnimationFraction += refreshRateAnimationFrames[refreshRateLevel];
+    steps = ledAnimationFraction >> LED_ANIMATION_FRAC_BITS;
+    ledAnimationFraction &= ((1uL << LED_ANIMATION_FRAC_BITS) - 1u);
+
+    return steps;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: GetProxLedBrightness
+********************************************************************************
+* Summary:
+*  Maps the proximity diff count to the LED brightness, from 0 at zero diff to
+*  SERIAL_LED_BRIGHTNESS_MAX at the maximum diff count (max raw count minus
+*  baseline). The scale factor is a Q16 reciprocal of the maximum diff count,
+*  recomputed only when the baseline or the max raw count changes, so no
+*  division is done per frame. A zero or negative maximum diff count gives the
+*  maximum brightness. With SERIAL_LED_GAMMA_EN the result is mapped through
+*  the perceptual brightness table.
+*
+*  Returns:
+*  LED brightness, 0 to SERIAL_LED_BRIGHTNESS_MAX
+*******************************************************************************/
+static uint8_t GetProxLedBrightness(void)
+{
+    static uint16_t scaleBsln = 0u;
+    static uint16_t scaleMaxRawCount = 0u;
+    static uint32_t brightnessScale = 0u;
+    static uint32_t maxDiffCount = 0u;
+
+    uint16_t bsln = cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].bsln;
+    uint16_t maxRawCount = cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID].maxRawCount;
+    uint32_t diff = cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].diff;
+    uint32_t brightness;
+
+    if ((bsln != scaleBsln) || (maxRawCount != scaleMaxRawCount) || (0u == brightnessScale))
+    {
+        scaleBsln = bsln;
+        scaleMaxRawCount = maxRawCount;
+
+        maxDiffCount = (maxRawCount > bsln) ? ((uint32_t)maxRawCount - bsln) : 0u;
+        brightnessScale = (0u != maxDiffCount) ?
+                          ((SERIAL_LED_BRIGHTNESS_MAX << PROX_BRIGHTNESS_SCALE_SHIFT) / maxDiffCount) : 1u;
+    }
+
+    /* Saturate at the maximum diff; below it the product fits in 32 bits */
+    if (diff >= maxDiffCount)
+    {
+        brightness = SERIAL_LED_BRIGHTNESS_MAX;
+    }
+    else
+    {
+        brightness = (diff * brightnessScale) >> PROX_BRIGHTNESS_SCALE_SHIFT;
+    }
+
+#if SERIAL_LED_GAMMA_EN
+    brightness = ledGammaTable[brightness];
+#endif
+
+    return (uint8_t)brightness;
 }
 #endif
 
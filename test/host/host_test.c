@@ -0,0 +1,540 @@
+/******************************************************************************
+* File Name: host_test.c
+*
+* Description: Host tests of the serial LED encoder, the proximity LED
+*              brightness and the application state machine.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "shim.h"
+
+/* The firmware under test, its static functions and data included. The
+* Makefile renames its main() to FirmwareMain() */
+#include "../../main.c"
+#undef main
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define LINE_SIZE_MAX                   (256u)
+
+/* Benchmark: calls per batch, batches of which the fastest is kept */
+#define BENCH_CALLS                     (10000u)
+#define BENCH_BATCHES                   (25u)
+#define BENCH_NAME_SIZE                 (32u)
+#define BENCH_FUNCTION_COUNT            (3u)
+
+/* Measurements of a function slower than its reference before it fails */
+#define BENCH_RETRIES                   (3u)
+
+/* Bytes of the reference workload that normalizes the benchmark */
+#define BENCH_REFERENCE_BYTES           (NUM_OF_LEDS * NUM_OF_LED_COLORS)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+#if (SERIAL_LED_TX_MODE == SERIAL_LED_TX_FULL)
+extern uint8_t ledTxBuffer[LED_BYTES_PER_PACKET];
+#endif
+
+static const char * const appStateName[APP_STATE_NUM] =
+{
+    [ACTIVE_MODE]   = "ACTIVE",
+    [ALR_MODE]      = "ALR",
+    [WOT_MODE]      = "WOT",
+    [BASELINE_MODE] = "BASELINE"
+};
+
+static volatile uint32_t benchSink;
+
+/*******************************************************************************
+* Function Name: PrintHex
+********************************************************************************
+* Summary:
+*  Prints bytes as hexadecimal digits.
+*
+*******************************************************************************/
+static void PrintHex(const uint8_t * data, uint32_t size)
+{
+    uint32_t i;
+
+    for (i = 0u; i < size; i++)
+    {
+        printf("%02x", data[i]);
+    }
+}
+
+/*******************************************************************************
+* Function Name: ReadHex
+********************************************************************************
+* Summary:
+*  Reads bytes written as hexadecimal digits.
+*
+* Return:
+*  true when the text holds exactly size bytes
+*
+*******************************************************************************/
+static bool ReadHex(const char * text, uint8_t * data, uint32_t size)
+{
+    uint32_t i;
+    unsigned int value;
+
+    for (i = 0u; i < size; i++)
+    {
+        if (1 != sscanf(&text[2u * i], "%2x", &value))
+        {
+            return false;
+        }
+        data[i] = (uint8_t)value;
+    }
+
+    return (('\0' == text[2u * size]) || ('\n' == text[2u * size]));
+}
+
+/*******************************************************************************
+* Function Name: RunLedTest
+********************************************************************************
+* Summary:
+*  Encodes each LED color frame of the file, one line of NUM_OF_LEDS red,
+*  green and blue bytes in hexadecimal, and prints it with the SPI frame sent
+*  by ProcessSerialLed(). The SPI frame must match the buffer encoded by
+*  EncodeSerialLed().
+*
+* Return:
+*  EXIT_SUCCESS when the frames are sent as encoded
+*
+*******************************************************************************/
+static int RunLedTest(const char * path)
+{
+    FILE * file = fopen(path, "r");
+    char line[LINE_SIZE_MAX];
+    serialLedContext_t frame;
+    const uint8_t * txData;
+    uint32_t txSize;
+    uint32_t txCount;
+
+    if (NULL == file)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    if (INIT_SUCCESS != InitSpiMaster())
+    {
+        fprintf(stderr, "InitSpiMaster() failed\n");
+        return EXIT_FAILURE;
+    }
+
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        if (('#' == line[0]) || ('\n' == line[0]))
+        {
+            continue;
+        }
+
+        if (!ReadHex(line, (uint8_t *)frame.serialLedData, sizeof(frame.serialLedData)))
+        {
+            fprintf(stderr, "%s: bad LED frame: %s", path, line);
+            return EXIT_FAILURE;
+        }
+
+        txCount = ShimGetSpiTxCount();
+        ProcessSerialLed(&frame);
+        txData = ShimGetSpiTxData(&txSize);
+
+        if (txCount == ShimGetSpiTxCount())
+        {
+            fprintf(stderr, "%s: LED frame not sent: %s", path, line);
+            return EXIT_FAILURE;
+        }
+
+#if (SERIAL_LED_TX_MODE == SERIAL_LED_TX_FULL)
+        EncodeSerialLed(&frame);
+        if ((LED_BYTES_PER_PACKET != txSize) || (0 != memcmp(txData, ledTxBuffer, txSize)))
+        {
+            fprintf(stderr, "%s: SPI frame differs from ledTxBuffer: %s", path, line);
+            return EXIT_FAILURE;
+        }
+#endif
+
+        PrintHex((const uint8_t *)frame.serialLedData, sizeof(frame.serialLedData));
+        printf(" ");
+        PrintHex(txData, txSize);
+        printf("\n");
+    }
+
+    fclose(file);
+    return EXIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: RunTraceTest
+********************************************************************************
+* Summary:
+*  Starts the firmware and runs one main loop pass per frame of the trace, each
+*  line being a frame count and the proximity and low power diff counts of
+*  these frames. Prints the frames where the state changes and the LED frames
+*  sent on SPI.
+*
+* Return:
+*  EXIT_SUCCESS when the trace is replayed
+*
+*******************************************************************************/
+static int RunTraceTest(const char * path)
+{
+    FILE * file = fopen(path, "r");
+    char line[LINE_SIZE_MAX];
+    unsigned int frames;
+    unsigned int proxDiff;
+    unsigned int lpDiff;
+    uint32_t frame = 0u;
+    uint32_t txCount;
+    uint32_t txSize;
+    const uint8_t * txData;
+    APPLICATION_STATE lastState;
+
+    if (NULL == file)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    InitializeApplication();
+    lastState = appState;
+    txCount = ShimGetSpiTxCount();
+    printf("%6u state %s\n", 0u, appStateName[appState]);
+
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        if (('#' == line[0]) || ('\n' == line[0]))
+        {
+            continue;
+        }
+
+        if (3 != sscanf(line, "%u %u %u", &frames, &proxDiff, &lpDiff))
+        {
+            fprintf(stderr, "%s: bad trace line: %s", path, line);
+            return EXIT_FAILURE;
+        }
+
+        ShimSetSensorDiff((uint16_t)proxDiff, (uint16_t)lpDiff);
+
+        for (; 0u != frames; frames--)
+        {
+            RunApplicationFrame();
+            frame++;
+
+            if (lastState != appState)
+            {
+                lastState = appState;
+                printf("%6u state %s\n", (unsigned int)frame, appStateName[appState]);
+            }
+
+            if (txCount != ShimGetSpiTxCount())
+            {
+                txCount = ShimGetSpiTxCount();
+                txData = ShimGetSpiTxData(&txSize);
+                printf("%6u led ", (unsigned int)frame);
+                PrintHex(txData, txSize);
+                printf("\n");
+            }
+        }
+    }
+
+    printf("%6u end\n", (unsigned int)frame);
+
+    fclose(file);
+    return EXIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: GetTimeNs
+********************************************************************************
+* Summary:
+*  Returns the host monotonic time in nanoseconds.
+*
+*******************************************************************************/
+static uint64_t GetTimeNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+/*******************************************************************************
+* Function Name: RunBenchReference
+********************************************************************************
+* Summary:
+*  Reference workload of the benchmark, a bitwise CRC-8 of the LED colors.
+*  Dividing the time of each function by its time cancels most of the speed
+*  difference between hosts.
+*
+*******************************************************************************/
+static __attribute__((noinline)) void RunBenchReference(void)
+{
+    const uint8_t * colorData = (const uint8_t *)ledContext.serialLedData;
+    uint32_t crc = 0u;
+    uint32_t i;
+    uint32_t bit;
+
+    for (i = 0u; i < BENCH_REFERENCE_BYTES; i++)
+    {
+        crc ^= colorData[i];
+        for (bit = 0u; bit < 8u; bit++)
+        {
+            crc = (0u != (crc & 0x80u)) ? (((crc << 1u) ^ 0x07u) & 0xFFu) : ((crc << 1u) & 0xFFu);
+        }
+    }
+
+    benchSink = crc;
+}
+
+static __attribute__((noinline)) void RunBenchEncodeSerialLed(void)
+{
+    EncodeSerialLed(&ledContext);
+}
+
+static __attribute__((noinline)) void RunBenchGetProxLedBrightness(void)
+{
+    benchSink = GetProxLedBrightness();
+}
+
+static __attribute__((noinline)) void RunBenchAppStateStep(void)
+{
+    AppStateStep();
+}
+
+/*******************************************************************************
+* Function Name: MeasureBatchNs
+********************************************************************************
+* Summary:
+*  Returns the time of BENCH_CALLS calls of the function in nanoseconds.
+*
+*******************************************************************************/
+static uint64_t MeasureBatchNs(void (*function)(void))
+{
+    uint64_t start = GetTimeNs();
+    uint32_t call;
+
+    for (call = 0u; call < BENCH_CALLS; call++)
+    {
+        function();
+    }
+
+    return GetTimeNs() - start;
+}
+
+/*******************************************************************************
+* Function Name: MeasureRatio
+********************************************************************************
+* Summary:
+*  Returns the run time of the function relative to the reference workload,
+*  the fastest of BENCH_BATCHES batches of each. The batches of the function
+*  and of the reference alternate, so both see the same host clock frequency.
+*
+*******************************************************************************/
+static double MeasureRatio(void (*function)(void))
+{
+    uint64_t referenceNs = UINT64_MAX;
+    uint64_t functionNs = UINT64_MAX;
+    uint64_t ns;
+    uint32_t batch;
+
+    /* Warms up the caches and the host clock */
+    (void)MeasureBatchNs(&RunBenchReference);
+    (void)MeasureBatchNs(function);
+
+    for (batch = 0u; batch < BENCH_BATCHES; batch++)
+    {
+        ns = MeasureBatchNs(&RunBenchReference);
+        if (ns < referenceNs)
+        {
+            referenceNs = ns;
+        }
+
+        ns = MeasureBatchNs(function);
+        if (ns < functionNs)
+        {
+            functionNs = ns;
+        }
+    }
+
+    return (double)functionNs / (double)referenceNs;
+}
+
+/*******************************************************************************
+* Function Name: RunBenchmark
+********************************************************************************
+* Summary:
+*  Measures EncodeSerialLed(), GetProxLedBrightness() and AppStateStep() in
+*  ACTIVE mode relative to the reference workload, and prints each ratio. With
+*  a reference file of the same lines, fails when a ratio exceeds the
+*  reference by more than tolerance percent.
+*
+* Return:
+*  EXIT_SUCCESS when no function is slower than its reference
+*
+*******************************************************************************/
+static int RunBenchmark(const char * referencePath, double tolerance)
+{
+    static const struct
+    {
+        const char * name;
+        void (*function)(void);
+    } benchFunction[BENCH_FUNCTION_COUNT] =
+    {
+        { "EncodeSerialLed",        &RunBenchEncodeSerialLed },
+        { "GetProxLedBrightness",   &RunBenchGetProxLedBrightness },
+        { "AppStateStep",           &RunBenchAppStateStep }
+    };
+    double limit[BENCH_FUNCTION_COUNT];
+    double ratio;
+    double retryRatio;
+    double referenceRatio;
+    char line[LINE_SIZE_MAX];
+    char name[BENCH_NAME_SIZE];
+    FILE * file;
+    int result = EXIT_SUCCESS;
+    uint32_t retry;
+    uint32_t i;
+
+    for (i = 0u; i < BENCH_FUNCTION_COUNT; i++)
+    {
+        limit[i] = HUGE_VAL;
+    }
+
+    if (NULL != referencePath)
+    {
+        file = fopen(referencePath, "r");
+        if (NULL == file)
+        {
+            perror(referencePath);
+            return EXIT_FAILURE;
+        }
+
+        while (NULL != fgets(line, sizeof(line), file))
+        {
+            if (('#' == line[0]) || (2 != sscanf(line, "%31s %lf", name, &referenceRatio)))
+            {
+                continue;
+            }
+
+            for (i = 0u; i < BENCH_FUNCTION_COUNT; i++)
+            {
+                if (0 == strcmp(name, benchFunction[i].name))
+                {
+                    limit[i] = referenceRatio * (1.0 + (tolerance / 100.0));
+                }
+            }
+        }
+        fclose(file);
+    }
+
+    InitializeApplication();
+
+    /* A proximity target keeps ACTIVE mode, with a LED color to encode */
+    ShimSetSensorDiff(1000u, 0u);
+    AppStateStep();
+    UpdateLeds();
+
+    for (i = 0u; i < BENCH_FUNCTION_COUNT; i++)
+    {
+        /* A slowdown is measured again, another process of the host may have
+        * run during the batches */
+        ratio = MeasureRatio(benchFunction[i].function);
+        for (retry = 0u; (retry < BENCH_RETRIES) && (ratio > limit[i]); retry++)
+        {
+            retryRatio = MeasureRatio(benchFunction[i].function);
+            ratio = (retryRatio < ratio) ? retryRatio : ratio;
+        }
+
+        printf("%s %.3f\n", benchFunction[i].name, ratio);
+
+        if (ratio > limit[i])
+        {
+            fflush(stdout);
+            fprintf(stderr, "%s: %.3f exceeds the reference by more than %.0f%%\n",
+                    benchFunction[i].name, ratio, tolerance);
+            result = EXIT_FAILURE;
+        }
+    }
+
+    if (ACTIVE_MODE != appState)
+    {
+        fprintf(stderr, "AppStateStep() left ACTIVE mode\n");
+        result = EXIT_FAILURE;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*  Runs one host test:
+*   led <frames>                  LED frames sent for the LED colors
+*   trace <trace>                 states and LED frames of a sensor trace
+*   bench [<reference> <tol %>]   relative run time of the firmware functions
+*
+*******************************************************************************/
+int main(int argc, char * argv[])
+{
+    if ((3 == argc) && (0 == strcmp(argv[1], "led")))
+    {
+        return RunLedTest(argv[2]);
+    }
+    if ((3 == argc) && (0 == strcmp(argv[1], "trace")))
+    {
+        return RunTraceTest(argv[2]);
+    }
+    if ((2 == argc) && (0 == strcmp(argv[1], "bench")))
+    {
+        return RunBenchmark(NULL, 0.0);
+    }
+    if ((4 == argc) && (0 == strcmp(argv[1], "bench")))
+    {
+        return RunBenchmark(argv[2], atof(argv[3]));
+    }
+
+    fprintf(stderr, "usage: %s led <frames> | trace <trace> | bench [<reference> <tolerance %%>]\n", argv[0]);
+    return EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
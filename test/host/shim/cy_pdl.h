@@ -0,0 +1,210 @@
+/******************************************************************************
+* File Name: cy_pdl.h
+*
+* Description: Host shim of the Peripheral Driver Library, the types and
+*              functions used by the application.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef HOST_SHIM_CY_PDL_H_
+#define HOST_SHIM_CY_PDL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/*******************************************************************************
+* Utilities
+*******************************************************************************/
+typedef uint32_t cy_rslt_t;
+#define CY_RSLT_SUCCESS                 (0u)
+
+/* A failed assertion ends the host test with an error, instead of halting */
+void ShimAssertFailed(const char * file, uint32_t line);
+#define CY_ASSERT(x)                    do { if (!(x)) { ShimAssertFailed(__FILE__, __LINE__); } } while (0)
+#define CY_UNUSED_PARAMETER(x)          ((void)(x))
+#define CY_SECTION(name)                __attribute__((section(name)))
+#define CY_ALIGN(align)                 __attribute__((aligned(align)))
+
+/*******************************************************************************
+* Peripheral instances, never dereferenced by the shims
+*******************************************************************************/
+typedef struct { uint32_t dummy; } CySCB_Type;
+typedef struct { uint32_t dummy; } MSCLP_Type;
+typedef struct { volatile uint32_t DR, DR_SET, DR_CLR, DR_INV; } GPIO_PRT_Type;
+
+extern CySCB_Type shimScb[2];
+extern MSCLP_Type shimMsclp;
+#define SCB0                            (&shimScb[0])
+#define SCB1                            (&shimScb[1])
+#define CY_MSCLP0_HW                    (&shimMsclp)
+
+#define GPIO_PRT_DR_INV(base)           ((base)->DR_INV)
+
+/*******************************************************************************
+* System power management
+*******************************************************************************/
+typedef enum { CY_SYSPM_SUCCESS = 0, CY_SYSPM_FAIL } cy_en_syspm_status_t;
+typedef enum
+{
+    CY_SYSPM_CHECK_READY,
+    CY_SYSPM_CHECK_FAIL,
+    CY_SYSPM_BEFORE_TRANSITION,
+    CY_SYSPM_AFTER_TRANSITION
+} cy_en_syspm_callback_mode_t;
+typedef enum { CY_SYSPM_DEEPSLEEP } cy_en_syspm_callback_type_t;
+typedef struct { void * base; void * context; } cy_stc_syspm_callback_params_t;
+typedef cy_en_syspm_status_t (*Cy_SysPmCallback)(cy_stc_syspm_callback_params_t *, cy_en_syspm_callback_mode_t);
+typedef struct cy_stc_syspm_callback
+{
+    Cy_SysPmCallback callback;
+    cy_en_syspm_callback_type_t type;
+    uint32_t skipMode;
+    cy_stc_syspm_callback_params_t * callbackParams;
+    struct cy_stc_syspm_callback * prevItm;
+    struct cy_stc_syspm_callback * nextItm;
+    uint8_t order;
+} cy_stc_syspm_callback_t;
+
+bool Cy_SysPm_RegisterCallback(cy_stc_syspm_callback_t * handler);
+cy_en_syspm_status_t Cy_SysPm_CpuEnterDeepSleep(void);
+cy_en_syspm_status_t Cy_SysPm_CpuEnterSleep(void);
+
+/*******************************************************************************
+* Clocks, interrupts, SysTick and system library
+*******************************************************************************/
+typedef enum { CY_SYSCLK_DIV_8_BIT, CY_SYSCLK_DIV_16_BIT } cy_en_divider_types_t;
+uint32_t Cy_SysClk_PeriphGetFrequency(cy_en_divider_types_t dividerType, uint32_t dividerNum);
+
+typedef enum { CY_SYSINT_SUCCESS = 0 } cy_en_sysint_status_t;
+typedef int32_t IRQn_Type;
+typedef struct { IRQn_Type intrSrc; uint32_t intrPriority; } cy_stc_sysint_t;
+cy_en_sysint_status_t Cy_SysInt_Init(const cy_stc_sysint_t * config, void (*userIsr)(void));
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void __enable_irq(void);
+
+uint32_t Cy_SysLib_EnterCriticalSection(void);
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus);
+
+#define CY_SYSTICK_CLOCK_SOURCE_CLK_CPU (0u)
+void Cy_SysTick_Init(uint32_t clockSource, uint32_t interval);
+uint32_t Cy_SysTick_GetValue(void);
+
+/*******************************************************************************
+* GPIO
+*******************************************************************************/
+#define CY_GPIO_DM_ANALOG               (0u)
+#define CY_GPIO_DM_STRONG_IN_OFF        (1u)
+void Cy_GPIO_SetDrivemode(GPIO_PRT_Type * base, uint32_t pinNum, uint32_t value);
+void Cy_GPIO_Set(GPIO_PRT_Type * base, uint32_t pinNum);
+void Cy_GPIO_Clr(GPIO_PRT_Type * base, uint32_t pinNum);
+
+/*******************************************************************************
+* SCB SPI
+*******************************************************************************/
+typedef enum
+{
+    CY_SCB_SPI_SUCCESS = 0,
+    CY_SCB_SPI_BAD_PARAM,
+    CY_SCB_SPI_TRANSFER_BUSY
+} cy_en_scb_spi_status_t;
+typedef struct { uint32_t status; } cy_stc_scb_spi_context_t;
+typedef struct { uint32_t oversample; } cy_stc_scb_spi_config_t;
+typedef void (*cy_cb_scb_spi_handle_events_t)(uint32_t event);
+
+#define CY_SCB_SPI_TRANSFER_CMPLT_EVENT (1u)
+#define CY_SCB_SPI_TRANSFER_ERR_EVENT   (2u)
+#define CY_SCB_SPI_SLAVE_SELECT0        (0u)
+#define CY_SCB_SPI_TX_TRIGGER           (1u)
+#define CY_SCB_SPI_MASTER_DONE          (1u)
+#define CY_SCB_SPI_INTR_NONE            (0u)
+
+cy_en_scb_spi_status_t Cy_SCB_SPI_Init(CySCB_Type * base, const cy_stc_scb_spi_config_t * config, cy_stc_scb_spi_context_t * context);
+void Cy_SCB_SPI_SetActiveSlaveSelect(CySCB_Type * base, uint32_t slaveSelect);
+void Cy_SCB_SPI_Enable(CySCB_Type * base);
+void Cy_SCB_SPI_Interrupt(CySCB_Type * base, cy_stc_scb_spi_context_t * context);
+void Cy_SCB_SPI_RegisterCallback(const CySCB_Type * base, cy_cb_scb_spi_handle_events_t callback, cy_stc_scb_spi_context_t * context);
+cy_en_scb_spi_status_t Cy_SCB_SPI_Transfer(CySCB_Type * base, void * txBuffer, void * rxBuffer, uint32_t size, cy_stc_scb_spi_context_t * context);
+void Cy_SCB_SPI_ClearTxFifo(CySCB_Type * base);
+void Cy_SCB_SPI_ClearRxFifo(CySCB_Type * base);
+uint32_t Cy_SCB_SPI_WriteArray(CySCB_Type * base, void * buffer, uint32_t size);
+uint32_t Cy_SCB_SPI_GetNumInTxFifo(const CySCB_Type * base);
+bool Cy_SCB_SPI_IsTxComplete(const CySCB_Type * base);
+void Cy_SCB_SPI_SetTxFifoLevel(CySCB_Type * base, uint32_t level);
+uint32_t Cy_SCB_SPI_GetTxInterruptStatusMasked(const CySCB_Type * base);
+void Cy_SCB_SPI_SetTxInterruptMask(CySCB_Type * base, uint32_t interruptMask);
+void Cy_SCB_SPI_ClearTxInterrupt(CySCB_Type * base, uint32_t interruptMask);
+uint32_t Cy_SCB_SPI_GetMasterInterruptStatusMasked(const CySCB_Type * base);
+void Cy_SCB_SPI_ClearMasterInterrupt(CySCB_Type * base, uint32_t interruptMask);
+void Cy_SCB_SPI_SetMasterInterruptMask(CySCB_Type * base, uint32_t interruptMask);
+cy_en_syspm_status_t Cy_SCB_SPI_DeepSleepCallback(cy_stc_syspm_callback_params_t * callbackParams, cy_en_syspm_callback_mode_t mode);
+
+/*******************************************************************************
+* SCB EZI2C
+*******************************************************************************/
+typedef enum { CY_SCB_EZI2C_SUCCESS = 0 } cy_en_scb_ezi2c_status_t;
+typedef struct { uint32_t status; } cy_stc_scb_ezi2c_context_t;
+typedef struct { uint32_t slaveAddress1; } cy_stc_scb_ezi2c_config_t;
+
+#define CY_SCB_EZI2C_STATUS_READ1       (1u)
+#define CY_SCB_EZI2C_STATUS_WRITE1      (2u)
+#define CY_SCB_EZI2C_STATUS_READ2       (4u)
+#define CY_SCB_EZI2C_STATUS_BUSY        (16u)
+
+cy_en_scb_ezi2c_status_t Cy_SCB_EZI2C_Init(CySCB_Type * base, const cy_stc_scb_ezi2c_config_t * config, cy_stc_scb_ezi2c_context_t * context);
+void Cy_SCB_EZI2C_SetBuffer1(const CySCB_Type * base, uint8_t * buffer, uint32_t size, uint32_t rwBoundary, cy_stc_scb_ezi2c_context_t * context);
+void Cy_SCB_EZI2C_SetBuffer2(const CySCB_Type * base, uint8_t * buffer, uint32_t size, uint32_t rwBoundary, cy_stc_scb_ezi2c_context_t * context);
+void Cy_SCB_EZI2C_Enable(CySCB_Type * base);
+void Cy_SCB_EZI2C_Interrupt(CySCB_Type * base, cy_stc_scb_ezi2c_context_t * context);
+uint32_t Cy_SCB_EZI2C_GetActivity(const CySCB_Type * base, cy_stc_scb_ezi2c_context_t * context);
+cy_en_syspm_status_t Cy_SCB_EZI2C_DeepSleepCallback(cy_stc_syspm_callback_params_t * callbackParams, cy_en_syspm_callback_mode_t mode);
+
+/*******************************************************************************
+* Flash and WDT
+*******************************************************************************/
+typedef enum { CY_FLASH_DRV_SUCCESS = 0 } cy_en_flashdrv_status_t;
+#define CY_FLASH_SIZEOF_ROW             (128u)
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t * data);
+
+#define srss_interrupt_IRQn             (6)
+uint32_t Cy_WDT_GetCount(void);
+void Cy_WDT_SetMatch(uint32_t match);
+void Cy_WDT_Enable(void);
+void Cy_WDT_ClearInterrupt(void);
+void Cy_WDT_UnmaskInterrupt(void);
+
+#endif /* HOST_SHIM_CY_PDL_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,62 @@
+/******************************************************************************
+* File Name: cycfg.h
+*
+* Description: Host shim of the Device Configurator generated code.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef HOST_SHIM_CYCFG_H_
+#define HOST_SHIM_CYCFG_H_
+
+#include "cy_pdl.h"
+
+/* Device Configurator names of the CY8CKIT-040T design */
+extern CySCB_Type * const CYBSP_MASTER_SPI_HW;
+extern CySCB_Type * const CYBSP_EZI2C_HW;
+extern const cy_stc_scb_spi_config_t CYBSP_MASTER_SPI_config;
+extern const cy_stc_scb_ezi2c_config_t CYBSP_EZI2C_config;
+#define CYBSP_MASTER_SPI_IRQ            (1)
+#define CYBSP_EZI2C_IRQ                 (2)
+#define CY_MSCLP0_LP_IRQ                (3)
+
+extern GPIO_PRT_Type * const CYBSP_SERIAL_LED_PORT;
+extern GPIO_PRT_Type * const CYBSP_SPI_MOSI_PORT;
+#define CYBSP_SERIAL_LED_NUM            (0u)
+#define CYBSP_SPI_MOSI_PIN              (0u)
+
+#define peri_0_div_16_0_HW              (CY_SYSCLK_DIV_16_BIT)
+#define peri_0_div_16_0_NUM             (0u)
+
+#endif /* HOST_SHIM_CYCFG_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name: cycfg_capsense.h
+*
+* Description: Host shim of the CAPSENSE Configurator generated code and
+*              of the CAPSENSE middleware API used by the application.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef HOST_SHIM_CYCFG_CAPSENSE_H_
+#define HOST_SHIM_CYCFG_CAPSENSE_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* CAPSENSE Configurator names of the CY8CKIT-040T design
+*******************************************************************************/
+#define CY_CAPSENSE_CPU_CLK                 (48000000u)
+#define CY_CAPSENSE_PROXIMITY0_WDGT_ID      (0u)
+#define CY_CAPSENSE_PROXIMITY0_SNS0_ID      (0u)
+#define CY_CAPSENSE_LOWPOWER0_WDGT_ID       (1u)
+#define CY_CAPSENSE_LOWPOWER0_SNS0_ID       (1u)
+#define CY_CAPSENSE_WIDGET_COUNT            (2u)
+#define CY_CAPSENSE_SENSOR_COUNT            (2u)
+
+/*******************************************************************************
+* CAPSENSE middleware data structure, the members used by the application
+*******************************************************************************/
+typedef uint32_t cy_capsense_status_t;
+#define CY_CAPSENSE_STATUS_SUCCESS          (0u)
+#define CY_CAPSENSE_STATUS_BAD_PARAM        (1u)
+#define CY_CAPSENSE_NOT_BUSY                (0u)
+#define CY_CAPSENSE_BUSY                    (1u)
+
+typedef struct
+{
+    uint16_t raw;
+    uint16_t bsln;
+    uint16_t diff;
+    uint8_t status;
+    uint8_t negBslnRstCnt;
+    uint8_t bslnExt;
+    uint8_t cdacComp;
+} cy_stc_capsense_sensor_context_t;
+
+typedef struct
+{
+    uint16_t fingerTh;
+    uint16_t proxTh;
+    uint16_t noiseTh;
+    uint16_t nNoiseTh;
+    uint16_t hysteresis;
+    uint16_t maxRawCount;
+    uint16_t snsClk;
+    uint16_t numSubConversions;
+    uint8_t cdacRef;
+    uint8_t status;
+} cy_stc_capsense_widget_context_t;
+
+typedef struct
+{
+    uint16_t configId;
+    uint16_t scanCounter;
+    uint32_t status;
+} cy_stc_capsense_common_context_t;
+
+typedef struct
+{
+    uint32_t wotScanInterval;
+    uint16_t wotTimeout;
+} cy_stc_capsense_internal_context_t;
+
+typedef struct
+{
+    cy_stc_capsense_common_context_t commonContext;
+    cy_stc_capsense_widget_context_t widgetContext[CY_CAPSENSE_WIDGET_COUNT];
+    cy_stc_capsense_sensor_context_t sensorContext[CY_CAPSENSE_SENSOR_COUNT];
+} cy_stc_capsense_tuner_t;
+
+typedef struct
+{
+    cy_stc_capsense_common_context_t * ptrCommonContext;
+    cy_stc_capsense_internal_context_t * ptrInternalContext;
+} cy_stc_capsense_context_t;
+
+extern cy_stc_capsense_context_t cy_capsense_context;
+extern cy_stc_capsense_tuner_t cy_capsense_tuner;
+
+/*******************************************************************************
+* CAPSENSE middleware API
+*******************************************************************************/
+cy_capsense_status_t Cy_CapSense_Init(cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_Enable(cy_stc_capsense_context_t * context);
+void Cy_CapSense_InterruptHandler(MSCLP_Type * base, cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_ScanAllSlots(cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_ScanAllLpSlots(cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_ScanWidget(uint32_t widgetId, cy_stc_capsense_context_t * context);
+uint32_t Cy_CapSense_IsBusy(const cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_ProcessAllWidgets(cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_ProcessWidget(uint32_t widgetId, cy_stc_capsense_context_t * context);
+uint32_t Cy_CapSense_IsAnyWidgetActive(const cy_stc_capsense_context_t * context);
+uint32_t Cy_CapSense_IsAnyLpWidgetActive(const cy_stc_capsense_context_t * context);
+uint32_t Cy_CapSense_IsWidgetActive(uint32_t widgetId, const cy_stc_capsense_context_t * context);
+uint32_t Cy_CapSense_IsProximitySensorActive(uint32_t widgetId, uint32_t sensorId, const cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_ConfigureMsclpTimer(uint32_t wakeupTimer, cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_ConfigureMsclpWotTimer(uint32_t wakeupTimer, cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_IloCompensate(cy_stc_capsense_context_t * context);
+uint32_t Cy_CapSense_RunTuner(cy_stc_capsense_context_t * context);
+cy_capsense_status_t Cy_CapSense_CalibrateWidget(uint32_t widgetId, cy_stc_capsense_context_t * context);
+void Cy_CapSense_InitializeWidgetBaseline(uint32_t widgetId, cy_stc_capsense_context_t * context);
+void Cy_CapSense_InitializeWidgetFilter(uint32_t widgetId, const cy_stc_capsense_context_t * context);
+
+#endif /* HOST_SHIM_CYCFG_CAPSENSE_H_ */
+
+/* [] END OF FILE */
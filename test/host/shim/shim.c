@@ -0,0 +1,543 @@
+/******************************************************************************
+* File Name: shim.c
+*
+* Description: Host shims of the PDL and CAPSENSE middleware. The scans
+*              complete on the CPU sleep, with the diff counts set by the
+*              test, and the SPI transfers complete right away.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "cybsp.h"
+#include "cycfg_capsense.h"
+#include "user_spi.h"
+#include "shim.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Interrupt sources, see cycfg.h */
+#define SHIM_IRQ_COUNT                  (8u)
+
+/* SysTick is a 24-bit down counter */
+#define SHIM_SYSTICK_MASK               (0xFFFFFFu)
+
+/* Proximity sensor status bits, see Cy_CapSense_IsProximitySensorActive() */
+#define SHIM_PROX_STATUS                (1u)
+#define SHIM_TOUCH_STATUS               (2u)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+CySCB_Type shimScb[2];
+MSCLP_Type shimMsclp;
+static GPIO_PRT_Type shimGpio[2];
+
+CySCB_Type * const CYBSP_MASTER_SPI_HW = SCB0;
+CySCB_Type * const CYBSP_EZI2C_HW = SCB1;
+GPIO_PRT_Type * const CYBSP_SERIAL_LED_PORT = &shimGpio[0];
+GPIO_PRT_Type * const CYBSP_SPI_MOSI_PORT = &shimGpio[1];
+
+const cy_stc_scb_spi_config_t CYBSP_MASTER_SPI_config = { .oversample = SPI_OVERSAMPLE };
+const cy_stc_scb_ezi2c_config_t CYBSP_EZI2C_config = { .slaveAddress1 = 8u };
+
+static cy_stc_capsense_common_context_t shimCommonContext;
+static cy_stc_capsense_internal_context_t shimInternalContext;
+
+cy_stc_capsense_context_t cy_capsense_context =
+{
+    .ptrCommonContext = &shimCommonContext,
+    .ptrInternalContext = &shimInternalContext
+};
+cy_stc_capsense_tuner_t cy_capsense_tuner;
+
+static void (*shimIsr[SHIM_IRQ_COUNT])(void);
+static cy_cb_scb_spi_handle_events_t shimSpiCallback = NULL;
+
+static uint32_t shimSysTick = SHIM_SYSTICK_MASK;
+
+/* Diff counts of the frames scanned from now on */
+static uint16_t shimProxDiff = 0u;
+static uint16_t shimLpDiff = 0u;
+
+/* Scan started and not completed, and whether it scans the low power slots */
+static bool shimScanPending = false;
+static bool shimScanLp = false;
+
+static uint8_t shimSpiTxData[SHIM_SPI_TX_SIZE_MAX];
+static uint32_t shimSpiTxSize = 0u;
+static uint32_t shimSpiTxCount = 0u;
+
+/*******************************************************************************
+* Function Name: ShimAssertFailed
+********************************************************************************
+* Summary:
+*  Ends the host test with an error when a CY_ASSERT() of the firmware fails.
+*
+*******************************************************************************/
+void ShimAssertFailed(const char * file, uint32_t line)
+{
+    fprintf(stderr, "%s:%u: CY_ASSERT failed\n", file, (unsigned int)line);
+    exit(EXIT_FAILURE);
+}
+
+/*******************************************************************************
+* Function Name: ShimSetSensorDiff
+********************************************************************************
+* Summary:
+*  Sets the diff counts of the proximity and low power sensors of the next
+*  scans.
+*
+*******************************************************************************/
+void ShimSetSensorDiff(uint16_t proxDiff, uint16_t lpDiff)
+{
+    shimProxDiff = proxDiff;
+    shimLpDiff = lpDiff;
+}
+
+/*******************************************************************************
+* Function Name: ShimGetSpiTxCount
+********************************************************************************
+* Summary:
+*  Returns the number of SPI transfers started since the startup.
+*
+*******************************************************************************/
+uint32_t ShimGetSpiTxCount(void)
+{
+    return shimSpiTxCount;
+}
+
+/*******************************************************************************
+* Function Name: ShimGetSpiTxData
+********************************************************************************
+* Summary:
+*  Returns the data of the last SPI transfer and its size.
+*
+*******************************************************************************/
+const uint8_t * ShimGetSpiTxData(uint32_t * size)
+{
+    *size = shimSpiTxSize;
+    return shimSpiTxData;
+}
+
+/*******************************************************************************
+* Function Name: CompleteScan
+********************************************************************************
+* Summary:
+*  Raises the MSCLP interrupt of the scan in progress, as the wake up from CPU
+*  Sleep or Deep Sleep. A sleep without a scan in progress would never wake up.
+*
+*******************************************************************************/
+static void CompleteScan(void)
+{
+    if ((!shimScanPending) || (NULL == shimIsr[CY_MSCLP0_LP_IRQ]))
+    {
+        fprintf(stderr, "CPU sleep without a wake up source\n");
+        exit(EXIT_FAILURE);
+    }
+
+    shimIsr[CY_MSCLP0_LP_IRQ]();
+}
+
+/*******************************************************************************
+* Function Name: UpdateSensorStatus
+********************************************************************************
+* Summary:
+*  Updates the diff count and the status of a sensor from its raw count with
+*  the widget thresholds and hysteresis, as the CAPSENSE middleware does.
+*
+*******************************************************************************/
+static void UpdateSensorStatus(uint32_t widgetId, uint32_t sensorId)
+{
+    cy_stc_capsense_widget_context_t * wd = &cy_capsense_tuner.widgetContext[widgetId];
+    cy_stc_capsense_sensor_context_t * sns = &cy_capsense_tuner.sensorContext[sensorId];
+    uint32_t diff = (sns->raw > sns->bsln) ? (uint32_t)(sns->raw - sns->bsln) : 0u;
+    uint32_t proxTh = (CY_CAPSENSE_PROXIMITY0_WDGT_ID == widgetId) ? wd->proxTh : wd->fingerTh;
+    uint32_t touchTh = wd->fingerTh;
+    uint32_t hysteresis = wd->hysteresis;
+    uint32_t status = 0u;
+
+    /* On at the threshold plus the hysteresis, off below the threshold minus
+    * the hysteresis */
+    if (diff >= ((0u != (sns->status & SHIM_PROX_STATUS)) ? (proxTh - hysteresis) : (proxTh + hysteresis)))
+    {
+        status |= SHIM_PROX_STATUS;
+    }
+    if ((CY_CAPSENSE_PROXIMITY0_WDGT_ID == widgetId) &&
+        (diff >= ((0u != (sns->status & SHIM_TOUCH_STATUS)) ? (touchTh - hysteresis) : (touchTh + hysteresis))))
+    {
+        status |= SHIM_TOUCH_STATUS;
+    }
+
+    sns->diff = (uint16_t)diff;
+    sns->status = (uint8_t)status;
+    wd->status = (uint8_t)((0u != status) ? 1u : 0u);
+}
+
+/*******************************************************************************
+* Board support, system and peripheral drivers
+*******************************************************************************/
+cy_rslt_t cybsp_init(void)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+bool Cy_SysPm_RegisterCallback(cy_stc_syspm_callback_t * handler)
+{
+    return (NULL != handler);
+}
+
+cy_en_syspm_status_t Cy_SysPm_CpuEnterDeepSleep(void)
+{
+    CompleteScan();
+    return CY_SYSPM_SUCCESS;
+}
+
+cy_en_syspm_status_t Cy_SysPm_CpuEnterSleep(void)
+{
+    shimSysTick = (shimSysTick - SHIM_TICKS_PER_SCAN) & SHIM_SYSTICK_MASK;
+    CompleteScan();
+    return CY_SYSPM_SUCCESS;
+}
+
+uint32_t Cy_SysClk_PeriphGetFrequency(cy_en_divider_types_t dividerType, uint32_t dividerNum)
+{
+    return SPI_SCB_CLK_HZ;
+}
+
+cy_en_sysint_status_t Cy_SysInt_Init(const cy_stc_sysint_t * config, void (*userIsr)(void))
+{
+    if ((uint32_t)config->intrSrc < SHIM_IRQ_COUNT)
+    {
+        shimIsr[config->intrSrc] = userIsr;
+    }
+    return CY_SYSINT_SUCCESS;
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {}
+void NVIC_ClearPendingIRQ(IRQn_Type irq) {}
+void __enable_irq(void) {}
+
+uint32_t Cy_SysLib_EnterCriticalSection(void)
+{
+    return 0u;
+}
+
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus) {}
+
+void Cy_SysTick_Init(uint32_t clockSource, uint32_t interval)
+{
+    shimSysTick = interval & SHIM_SYSTICK_MASK;
+}
+
+uint32_t Cy_SysTick_GetValue(void)
+{
+    shimSysTick = (shimSysTick - SHIM_TICKS_PER_READ) & SHIM_SYSTICK_MASK;
+    return shimSysTick;
+}
+
+void Cy_GPIO_SetDrivemode(GPIO_PRT_Type * base, uint32_t pinNum, uint32_t value) {}
+void Cy_GPIO_Set(GPIO_PRT_Type * base, uint32_t pinNum) {}
+void Cy_GPIO_Clr(GPIO_PRT_Type * base, uint32_t pinNum) {}
+
+/* The SPI transfer completes right away, with the event of the SPI interrupt */
+cy_en_scb_spi_status_t Cy_SCB_SPI_Init(CySCB_Type * base, const cy_stc_scb_spi_config_t * config, cy_stc_scb_spi_context_t * context)
+{
+    return CY_SCB_SPI_SUCCESS;
+}
+
+void Cy_SCB_SPI_SetActiveSlaveSelect(CySCB_Type * base, uint32_t slaveSelect) {}
+void Cy_SCB_SPI_Enable(CySCB_Type * base) {}
+void Cy_SCB_SPI_Interrupt(CySCB_Type * base, cy_stc_scb_spi_context_t * context) {}
+
+void Cy_SCB_SPI_RegisterCallback(const CySCB_Type * base, cy_cb_scb_spi_handle_events_t callback, cy_stc_scb_spi_context_t * context)
+{
+    shimSpiCallback = callback;
+}
+
+cy_en_scb_spi_status_t Cy_SCB_SPI_Transfer(CySCB_Type * base, void * txBuffer, void * rxBuffer, uint32_t size, cy_stc_scb_spi_context_t * context)
+{
+    if ((NULL == txBuffer) || (SHIM_SPI_TX_SIZE_MAX < size))
+    {
+        return CY_SCB_SPI_BAD_PARAM;
+    }
+
+    memcpy(shimSpiTxData, txBuffer, size);
+    shimSpiTxSize = size;
+    shimSpiTxCount++;
+
+    if (NULL != shimSpiCallback)
+    {
+        shimSpiCallback(CY_SCB_SPI_TRANSFER_CMPLT_EVENT);
+    }
+    return CY_SCB_SPI_SUCCESS;
+}
+
+void Cy_SCB_SPI_ClearTxFifo(CySCB_Type * base) {}
+void Cy_SCB_SPI_ClearRxFifo(CySCB_Type * base) {}
+
+/* The streamed transfer is not simulated, SERIAL_LED_TX_STREAM is not tested */
+uint32_t Cy_SCB_SPI_WriteArray(CySCB_Type * base, void * buffer, uint32_t size)
+{
+    return 0u;
+}
+
+uint32_t Cy_SCB_SPI_GetNumInTxFifo(const CySCB_Type * base)
+{
+    return 0u;
+}
+
+bool Cy_SCB_SPI_IsTxComplete(const CySCB_Type * base)
+{
+    return true;
+}
+
+void Cy_SCB_SPI_SetTxFifoLevel(CySCB_Type * base, uint32_t level) {}
+
+uint32_t Cy_SCB_SPI_GetTxInterruptStatusMasked(const CySCB_Type * base)
+{
+    return 0u;
+}
+
+void Cy_SCB_SPI_SetTxInterruptMask(CySCB_Type * base, uint32_t interruptMask) {}
+void Cy_SCB_SPI_ClearTxInterrupt(CySCB_Type * base, uint32_t interruptMask) {}
+
+uint32_t Cy_SCB_SPI_GetMasterInterruptStatusMasked(const CySCB_Type * base)
+{
+    return 0u;
+}
+
+void Cy_SCB_SPI_ClearMasterInterrupt(CySCB_Type * base, uint32_t interruptMask) {}
+void Cy_SCB_SPI_SetMasterInterruptMask(CySCB_Type * base, uint32_t interruptMask) {}
+
+cy_en_syspm_status_t Cy_SCB_SPI_DeepSleepCallback(cy_stc_syspm_callback_params_t * callbackParams, cy_en_syspm_callback_mode_t mode)
+{
+    return CY_SYSPM_SUCCESS;
+}
+
+/* No host is connected on EZI2C */
+cy_en_scb_ezi2c_status_t Cy_SCB_EZI2C_Init(CySCB_Type * base, const cy_stc_scb_ezi2c_config_t * config, cy_stc_scb_ezi2c_context_t * context)
+{
+    return CY_SCB_EZI2C_SUCCESS;
+}
+
+void Cy_SCB_EZI2C_SetBuffer1(const CySCB_Type * base, uint8_t * buffer, uint32_t size, uint32_t rwBoundary, cy_stc_scb_ezi2c_context_t * context) {}
+void Cy_SCB_EZI2C_SetBuffer2(const CySCB_Type * base, uint8_t * buffer, uint32_t size, uint32_t rwBoundary, cy_stc_scb_ezi2c_context_t * context) {}
+void Cy_SCB_EZI2C_Enable(CySCB_Type * base) {}
+void Cy_SCB_EZI2C_Interrupt(CySCB_Type * base, cy_stc_scb_ezi2c_context_t * context) {}
+
+uint32_t Cy_SCB_EZI2C_GetActivity(const CySCB_Type * base, cy_stc_scb_ezi2c_context_t * context)
+{
+    return 0u;
+}
+
+cy_en_syspm_status_t Cy_SCB_EZI2C_DeepSleepCallback(cy_stc_syspm_callback_params_t * callbackParams, cy_en_syspm_callback_mode_t mode)
+{
+    return CY_SYSPM_SUCCESS;
+}
+
+/* The flash row is not written, a snapshot is never restored */
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t * data)
+{
+    return CY_FLASH_DRV_SUCCESS;
+}
+
+uint32_t Cy_WDT_GetCount(void)
+{
+    return 0u;
+}
+
+void Cy_WDT_SetMatch(uint32_t match) {}
+void Cy_WDT_Enable(void) {}
+void Cy_WDT_ClearInterrupt(void) {}
+void Cy_WDT_UnmaskInterrupt(void) {}
+
+/*******************************************************************************
+* CAPSENSE middleware
+*******************************************************************************/
+cy_capsense_status_t Cy_CapSense_Init(cy_stc_capsense_context_t * context)
+{
+    cy_stc_capsense_widget_context_t * prox = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID];
+    cy_stc_capsense_widget_context_t * lp = &cy_capsense_tuner.widgetContext[CY_CAPSENSE_LOWPOWER0_WDGT_ID];
+    uint32_t i;
+
+    /* Widget parameters of design.cycapsense */
+    prox->fingerTh = 2970u;
+    prox->proxTh = 96u;
+    prox->noiseTh = 48u;
+    prox->nNoiseTh = 48u;
+    prox->hysteresis = 12u;
+    prox->maxRawCount = SHIM_PROX_MAX_RAW_COUNT;
+    prox->numSubConversions = 520u;
+    prox->snsClk = 48u;
+    prox->cdacRef = 12u;
+
+    lp->fingerTh = 96u;
+    lp->proxTh = 200u;
+    lp->noiseTh = 48u;
+    lp->nNoiseTh = 48u;
+    lp->hysteresis = 10u;
+    lp->maxRawCount = SHIM_PROX_MAX_RAW_COUNT;
+    lp->numSubConversions = 520u;
+    lp->snsClk = 48u;
+    lp->cdacRef = 12u;
+
+    for (i = 0u; i < CY_CAPSENSE_SENSOR_COUNT; i++)
+    {
+        cy_capsense_tuner.sensorContext[i].raw = SHIM_SENSOR_BASELINE;
+        cy_capsense_tuner.sensorContext[i].bsln = SHIM_SENSOR_BASELINE;
+    }
+
+    context->ptrInternalContext->wotScanInterval = 62500u;
+    context->ptrInternalContext->wotTimeout = 160u;
+
+    return CY_CAPSENSE_STATUS_SUCCESS;
+}
+
+cy_capsense_status_t Cy_CapSense_Enable(cy_stc_capsense_context_t * context)
+{
+    return CY_CAPSENSE_STATUS_SUCCESS;
+}
+
+void Cy_CapSense_InterruptHandler(MSCLP_Type * base, cy_stc_capsense_context_t * context)
+{
+    if (shimScanLp)
+    {
+        cy_capsense_tuner.sensorContext[CY_CAPSENSE_LOWPOWER0_SNS0_ID].raw = (uint16_t)(SHIM_SENSOR_BASELINE + shimLpDiff);
+    }
+    else
+    {
+        cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].raw = (uint16_t)(SHIM_SENSOR_BASELINE + shimProxDiff);
+    }
+
+    shimScanPending = false;
+    context->ptrCommonContext->scanCounter++;
+}
+
+cy_capsense_status_t Cy_CapSense_ScanAllSlots(cy_stc_capsense_context_t * context)
+{
+    shimScanPending = true;
+    shimScanLp = false;
+    return CY_CAPSENSE_STATUS_SUCCESS;
+}
+
+cy_capsense_status_t Cy_CapSense_ScanAllLpSlots(cy_stc_capsense_context_t * context)
+{
+    shimScanPending = true;
+    shimScanLp = true;
+    return CY_CAPSENSE_STATUS_SUCCESS;
+}
+
+cy_capsense_status_t Cy_CapSense_ScanWidget(uint32_t widgetId, cy_stc_capsense_context_t * context)
+{
+    return Cy_CapSense_ScanAllSlots(context);
+}
+
+uint32_t Cy_CapSense_IsBusy(const cy_stc_capsense_context_t * context)
+{
+    return shimScanPending ? CY_CAPSENSE_BUSY : CY_CAPSENSE_NOT_BUSY;
+}
+
+cy_capsense_status_t Cy_CapSense_ProcessAllWidgets(cy_stc_capsense_context_t * context)
+{
+    /* The low power widget is scanned only in the low power slots */
+    return Cy_CapSense_ProcessWidget(CY_CAPSENSE_PROXIMITY0_WDGT_ID, context);
+}
+
+cy_capsense_status_t Cy_CapSense_ProcessWidget(uint32_t widgetId, cy_stc_capsense_context_t * context)
+{
+    if (CY_CAPSENSE_WIDGET_COUNT <= widgetId)
+    {
+        return CY_CAPSENSE_STATUS_BAD_PARAM;
+    }
+
+    UpdateSensorStatus(widgetId, (CY_CAPSENSE_PROXIMITY0_WDGT_ID == widgetId) ?
+                       CY_CAPSENSE_PROXIMITY0_SNS0_ID : CY_CAPSENSE_LOWPOWER0_SNS0_ID);
+    return CY_CAPSENSE_STATUS_SUCCESS;
+}
+
+uint32_t Cy_CapSense_IsAnyWidgetActive(const cy_stc_capsense_context_t * context)
+{
+    return cy_capsense_tuner.widgetContext[CY_CAPSENSE_PROXIMITY0_WDGT_ID].status;
+}
+
+uint32_t Cy_CapSense_IsAnyLpWidgetActive(const cy_stc_capsense_context_t * context)
+{
+    return cy_capsense_tuner.widgetContext[CY_CAPSENSE_LOWPOWER0_WDGT_ID].status;
+}
+
+uint32_t Cy_CapSense_IsWidgetActive(uint32_t widgetId, const cy_stc_capsense_context_t * context)
+{
+    return (CY_CAPSENSE_WIDGET_COUNT > widgetId) ? cy_capsense_tuner.widgetContext[widgetId].status : 0u;
+}
+
+uint32_t Cy_CapSense_IsProximitySensorActive(uint32_t widgetId, uint32_t sensorId, const cy_stc_capsense_context_t * context)
+{
+    return (CY_CAPSENSE_SENSOR_COUNT > sensorId) ? cy_capsense_tuner.sensorContext[sensorId].status : 0u;
+}
+
+cy_capsense_status_t Cy_CapSense_ConfigureMsclpTimer(uint32_t wakeupTimer, cy_stc_capsense_context_t * context)
+{
+    return CY_CAPSENSE_STATUS_SUCCESS;
+}
+
+cy_capsense_status_t Cy_CapSense_ConfigureMsclpWotTimer(uint32_t wakeupTimer, cy_stc_capsense_context_t * context)
+{
+    return CY_CAPSENSE_STATUS_SUCCESS;
+}
+
+cy_capsense_status_t Cy_CapSense_IloCompensate(cy_stc_capsense_context_t * context)
+{
+    return CY_CAPSENSE_STATUS_SUCCESS;
+}
+
+uint32_t Cy_CapSense_RunTuner(cy_stc_capsense_context_t * context)
+{
+    return 0u;
+}
+
+cy_capsense_status_t Cy_CapSense_CalibrateWidget(uint32_t widgetId, cy_stc_capsense_context_t * context)
+{
+    return (CY_CAPSENSE_WIDGET_COUNT > widgetId) ? CY_CAPSENSE_STATUS_SUCCESS : CY_CAPSENSE_STATUS_BAD_PARAM;
+}
+
+void Cy_CapSense_InitializeWidgetBaseline(uint32_t widgetId, cy_stc_capsense_context_t * context)
+{
+    /* The simulated raw counts are relative to a fixed baseline */
+}
+
+void Cy_CapSense_InitializeWidgetFilter(uint32_t widgetId, const cy_stc_capsense_context_t * context) {}
+
+/* [] END OF FILE */
@@ -0,0 +1,71 @@
+/******************************************************************************
+* File Name: shim.h
+*
+* Description: Control of the host shims by the host tests: the sensor
+*              diff counts to scan and the SPI frames sent.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef HOST_SHIM_H_
+#define HOST_SHIM_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Baseline of the simulated sensors, the raw count is the baseline plus the
+* diff count of the trace */
+#define SHIM_SENSOR_BASELINE            (1000u)
+
+/* Max raw count of the simulated proximity sensor */
+#define SHIM_PROX_MAX_RAW_COUNT         (5000u)
+
+/* SysTick ticks counted for each SysTick read, and for each CPU Sleep until
+* the scan complete interrupt. SysTick does not count in Deep Sleep */
+#define SHIM_TICKS_PER_READ             (48u)
+#define SHIM_TICKS_PER_SCAN             (48u * 400u)
+
+/* Bytes kept of the last SPI transfer */
+#define SHIM_SPI_TX_SIZE_MAX            (256u)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void ShimSetSensorDiff(uint16_t proxDiff, uint16_t lpDiff);
+uint32_t ShimGetSpiTxCount(void);
+const uint8_t * ShimGetSpiTxData(uint32_t * size);
+
+#endif /* HOST_SHIM_H_ */
+
+/* [] END OF FILE */
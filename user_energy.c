@@ -0,0 +1,272 @@
+/*******************************************************************************
+ * File Name:   user_energy.c
+ *
+ * Description: This file contains the per-state energy accounting. It charges
+ *              the ILO ticks elapsed since the last accounting point to the
+ *              current application state, CPU power domain and active
+ *              communication peripherals.
+ *
+ *******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+ ******************************************************************************/
+
+#include <string.h>
+#include "user_energy.h"
+
+#if ENABLE_ENERGY_ACCOUNTING
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* The WDT counter is 16 bits wide */
+#define ENERGY_TICK_MSK             (0xFFFFu)
+
+/* The WDT interrupt is raised once per counter wrap */
+#define ENERGY_WDT_MATCH            (0u)
+
+#define ENERGY_WDT_INTR_PRIORITY    (3u)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void EnergyAccount(void);
+static void EnergyWdtIsr(void);
+
+/*******************************************************************************
+* Global Definitions
+*******************************************************************************/
+/* Energy data, placed in the host interface */
+static energyData_t * energyData = NULL;
+
+/* WDT counter at the last accounting point */
+static uint32_t lastTicks;
+
+static uint8_t currentState = 0u;
+static energyDomain_t currentDomain = ENERGY_DOMAIN_CPU_ACTIVE;
+
+/* Bit per energyComm_t, set while the peripheral is active */
+static uint32_t activeComm = 0u;
+
+/*******************************************************************************
+* Function Name: InitEnergy
+********************************************************************************
+* Summary:
+* Sets and clears the energy data and starts the WDT counter with an interrupt
+* on every counter wrap. The WDT interrupt is cleared in EnergyWdtIsr(), so the
+* WDT never resets the device.
+*
+* Parameters:
+* data - pointer to the energy data
+*
+*******************************************************************************/
+void InitEnergy(energyData_t * data)
+{
+    const cy_stc_sysint_t wdtInterruptConfig =
+    {
+        .intrSrc = srss_interrupt_IRQn,
+        .intrPriority = ENERGY_WDT_INTR_PRIORITY,
+    };
+
+    memset(data, 0, sizeof(*data));
+
+    data->version = ENERGY_DATA_VERSION;
+    data->stateNum = (uint8_t)ENERGY_STATE_NUM;
+    data->domainNum = (uint8_t)ENERGY_DOMAIN_NUM;
+    data->commNum = (uint8_t)ENERGY_COMM_NUM;
+    data->tickFreq = ENERGY_TICK_FREQ;
+
+    Cy_WDT_SetMatch(ENERGY_WDT_MATCH);
+    Cy_WDT_ClearInterrupt();
+    Cy_WDT_UnmaskInterrupt();
+
+    Cy_SysInt_Init(&wdtInterruptConfig, EnergyWdtIsr);
+    NVIC_ClearPendingIRQ(wdtInterruptConfig.intrSrc);
+    NVIC_EnableIRQ(wdtInterruptConfig.intrSrc);
+
+    Cy_WDT_Enable();
+
+    lastTicks = Cy_WDT_GetCount();
+    energyData = data;
+}
+
+/*******************************************************************************
+* Function Name: EnergySetState
+********************************************************************************
+* Summary:
+* Charges the elapsed time to the previous state and switches to the state.
+*
+* Parameters:
+* state - application state entered
+*
+*******************************************************************************/
+void EnergySetState(uint8_t state)
+{
+    uint32_t interruptStatus = Cy_SysLib_EnterCriticalSection();
+
+    EnergyAccount();
+    currentState = (state < ENERGY_STATE_NUM) ? state : 0u;
+
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+}
+
+/*******************************************************************************
+* Function Name: EnergySetDomain
+********************************************************************************
+* Summary:
+* Charges the elapsed time to the previous CPU power domain and switches to the
+* domain. Called right before and after the CPU enters Sleep or Deep Sleep.
+*
+* Parameters:
+* domain - CPU power domain entered
+*
+*******************************************************************************/
+void EnergySetDomain(energyDomain_t domain)
+{
+    uint32_t interruptStatus = Cy_SysLib_EnterCriticalSection();
+
+    EnergyAccount();
+    currentDomain = domain;
+
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+}
+
+/*******************************************************************************
+* Function Name: EnergyCommStart
+********************************************************************************
+* Summary:
+* Marks the start of a communication peripheral activity. Can be called from
+* an interrupt.
+*
+* Parameters:
+* comm - communication peripheral
+*
+*******************************************************************************/
+void EnergyCommStart(energyComm_t comm)
+{
+    uint32_t interruptStatus = Cy_SysLib_EnterCriticalSection();
+
+    EnergyAccount();
+    activeComm |= (1uL << (uint32_t)comm);
+
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+}
+
+/*******************************************************************************
+* Function Name: EnergyCommStop
+********************************************************************************
+* Summary:
+* Marks the end of a communication peripheral activity. Can be called from an
+* interrupt.
+*
+* Parameters:
+* comm - communication peripheral
+*
+*******************************************************************************/
+void EnergyCommStop(energyComm_t comm)
+{
+    uint32_t interruptStatus = Cy_SysLib_EnterCriticalSection();
+
+    EnergyAccount();
+    activeComm &= ~(1uL << (uint32_t)comm);
+
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+}
+
+/*******************************************************************************
+* Function Name: EnergyCountDeepSleepRefused
+********************************************************************************
+* Summary:
+* Counts a Deep Sleep request refused by a Deep Sleep callback.
+*
+*******************************************************************************/
+void EnergyCountDeepSleepRefused(void)
+{
+    if (NULL != energyData)
+    {
+        energyData->deepSleepRefused++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: EnergyAccount
+********************************************************************************
+* Summary:
+* Charges the ILO ticks elapsed since the last accounting point to the current
+* state, CPU power domain and the active communication peripherals. Called in
+* a critical section.
+*
+*******************************************************************************/
+static void EnergyAccount(void)
+{
+    energyStateStats_t * stats;
+    uint32_t ticks;
+    uint32_t elapsed;
+    uint32_t comm;
+
+    if (NULL == energyData)
+    {
+        return;
+    }
+
+    ticks = Cy_WDT_GetCount();
+    elapsed = (ticks - lastTicks) & ENERGY_TICK_MSK;
+    lastTicks = ticks;
+
+    stats = &energyData->stats[currentState];
+    stats->domainTicks[currentDomain] += elapsed;
+
+    for (comm = 0u; comm < (uint32_t)ENERGY_COMM_NUM; comm++)
+    {
+        if (0u != (activeComm & (1uL << comm)))
+        {
+            stats->commTicks[comm] += elapsed;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: EnergyWdtIsr
+********************************************************************************
+* Summary:
+* Accounts the elapsed time once per WDT counter wrap, so no wrap is lost in a
+* long Deep Sleep, and clears the WDT interrupt.
+*
+*******************************************************************************/
+static void EnergyWdtIsr(void)
+{
+    EnergyAccount();
+    Cy_WDT_ClearInterrupt();
+}
+
+#endif /* ENABLE_ENERGY_ACCOUNTING */
+
+/* [] END OF FILE */
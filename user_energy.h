@@ -0,0 +1,132 @@
+/******************************************************************************
+* File Name: user_energy.h
+*
+* Description: This file contains the macros, data types and function
+*              prototypes of the per-state energy accounting.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_USER_ENERGY_H_
+#define SOURCE_USER_ENERGY_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* User configurable Macros
+*******************************************************************************/
+/* Enable this, to count the time spent in each application state, split into
+* CPU active, CPU Sleep and Deep Sleep time, and the SPI and I2C active time.
+* The time is counted in ILO ticks of the WDT counter, which also runs in
+* Deep Sleep. The WDT interrupt wakes the device once per counter wrap */
+#ifndef ENABLE_ENERGY_ACCOUNTING
+#define ENABLE_ENERGY_ACCOUNTING    (0u)
+#endif
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Layout version of energyData_t, incremented on every layout change */
+#define ENERGY_DATA_VERSION         (1u)
+
+/* Number of application states counted, covers the APPLICATION_STATE values */
+#define ENERGY_STATE_NUM            (5u)
+
+/* Nominal ILO frequency, the WDT counter clock */
+#define ENERGY_TICK_FREQ            (40000u)
+
+#if ENABLE_ENERGY_ACCOUNTING
+    #define ENERGY_SET_DOMAIN(domain)   EnergySetDomain(domain)
+    #define ENERGY_COMM_START(comm)     EnergyCommStart(comm)
+    #define ENERGY_COMM_STOP(comm)      EnergyCommStop(comm)
+    #define ENERGY_DEEP_SLEEP_REFUSED() EnergyCountDeepSleepRefused()
+#else
+    #define ENERGY_SET_DOMAIN(domain)
+    #define ENERGY_COMM_START(comm)
+    #define ENERGY_COMM_STOP(comm)
+    #define ENERGY_DEEP_SLEEP_REFUSED()
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+/* CPU power domains, exactly one is current at a time */
+typedef enum
+{
+    ENERGY_DOMAIN_CPU_ACTIVE = 0u,      /* CPU running */
+    ENERGY_DOMAIN_CPU_SLEEP,            /* Cy_SysPm_CpuEnterSleep() */
+    ENERGY_DOMAIN_DEEP_SLEEP,           /* Cy_SysPm_CpuEnterDeepSleep() */
+    ENERGY_DOMAIN_NUM
+} energyDomain_t;
+
+/* Communication peripherals, counted on top of the CPU power domain */
+typedef enum
+{
+    ENERGY_COMM_SPI = 0u,               /* LED frame SPI transfer */
+    ENERGY_COMM_I2C,                    /* EZI2C transaction */
+    ENERGY_COMM_NUM
+} energyComm_t;
+
+/* Time spent in an application state in ILO ticks */
+typedef struct energyStateStats
+{
+    uint32_t domainTicks[ENERGY_DOMAIN_NUM];
+    uint32_t commTicks[ENERGY_COMM_NUM];
+} energyStateStats_t;
+
+/* Energy accounting data, exposed in the host interface on the EZI2C secondary
+* slave address. The tick counters wrap, the host computes the current per
+* state from the difference of two reads */
+typedef struct energyData
+{
+    uint8_t version;            /* ENERGY_DATA_VERSION */
+    uint8_t stateNum;           /* ENERGY_STATE_NUM */
+    uint8_t domainNum;          /* ENERGY_DOMAIN_NUM */
+    uint8_t commNum;            /* ENERGY_COMM_NUM */
+    uint32_t tickFreq;          /* ENERGY_TICK_FREQ in Hz */
+    uint32_t deepSleepRefused;  /* Cy_SysPm_CpuEnterDeepSleep() calls refused by a callback */
+    energyStateStats_t stats[ENERGY_STATE_NUM];
+} energyData_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void InitEnergy(energyData_t *);
+void EnergySetState(uint8_t);
+void EnergySetDomain(energyDomain_t);
+void EnergyCommStart(energyComm_t);
+void EnergyCommStop(energyComm_t);
+void EnergyCountDeepSleepRefused(void);
+
+#endif /* SOURCE_USER_ENERGY_H_ */
+
+/* [] END OF FILE */
@@ -37,29 +37,281 @@
 * so agrees to indemnify Cypress against all liability.
  ******************************************************************************/
 
+#include <string.h>
 #include "user_led_control.h"
 
 
 /*******************************************************************************
 * Global Definitions
 *******************************************************************************/
+#if (SERIAL_LED_TX_MODE == SERIAL_LED_TX_FULL)
 uint8_t ledTxBuffer[LED_BYTES_PER_PACKET];
+#elif (SERIAL_LED_TX_MODE == SERIAL_LED_TX_STREAM)
+/* SPI frame of the color being streamed and the index of its next byte */
+static uint8_t ledStreamColor[TX_BYTES_PER_LED_COLOR];
+static uint32_t ledStreamByte;
+
+/* Next color of ledSentContext to be encoded */
+static uint32_t ledNextColor;
+#else
+/* Two chunk buffers, the first chunk of a frame starts with the reset byte */
+static uint8_t ledChunkBuffer[2u][LED_RESET_BYTES + LED_BYTES_PER_CHUNK];
+
+/* Next color of ledSentContext to be encoded */
+static uint32_t ledNextColor;
+
+/* Chunk buffer encoded in advance and its size, 0 - the frame is complete */
+static uint32_t ledPendingChunk;
+static uint32_t ledPendingChunkSize;
+
+/* Set while the chunks of a frame are transmitted */
+static volatile bool ledFrameActive = false;
+#endif
 
 serialLedContext_t ledContext;
 
+/* Copy of the LED data of the last frame sent to the LEDs */
+static serialLedContext_t ledSentContext;
+static bool ledSentContextValid = false;
+static uint32_t ledUnchangedFrameCount = 0u;
+
+/* Animation of each LED, the LEDs start off and not animated */
+static ledAnimation_t ledAnimation[NUM_OF_LEDS];
+
+#if SERIAL_LED_LUT_ENCODER_EN
+/* Expands to the LED_ENCODE_COLOR() frames of 4, 16 and 64 consecutive color
+* byte values */
+#define LED_ENCODE_4(color)         LED_ENCODE_COLOR(color), LED_ENCODE_COLOR((color) + 1u), \
+                                    LED_ENCODE_COLOR((color) + 2u), LED_ENCODE_COLOR((color) + 3u)
+#define LED_ENCODE_16(color)        LED_ENCODE_4(color), LED_ENCODE_4((color) + 4u), \
+                                    LED_ENCODE_4((color) + 8u), LED_ENCODE_4((color) + 12u)
+#define LED_ENCODE_64(color)        LED_ENCODE_16(color), LED_ENCODE_16((color) + 16u), \
+                                    LED_ENCODE_16((color) + 32u), LED_ENCODE_16((color) + 48u)
+
+/* SPI frame of each color byte value, generated at compile time from the LED
+* timing and the SPI data rate. Placed in flash. */
+static const uint32_t ledEncodeTable[256u] =
+{
+    LED_ENCODE_64(0u), LED_ENCODE_64(64u), LED_ENCODE_64(128u), LED_ENCODE_64(192u)
+};
+#endif
+
+#if SERIAL_LED_GAMMA_EN
+/* Perceptual brightness: 255 * (i / 255)^2.2, at least 1 for a non-zero input
+* so that a dim LED does not turn off. Placed in flash. */
+const uint8_t ledGammaTable[256u] =
+{
+      0u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,
+      1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   2u,   2u,   2u,   2u,   2u,   2u,   2u,
+      3u,   3u,   3u,   3u,   3u,   4u,   4u,   4u,   4u,   5u,   5u,   5u,   5u,   6u,   6u,   6u,
+      6u,   7u,   7u,   7u,   8u,   8u,   8u,   9u,   9u,   9u,  10u,  10u,  11u,  11u,  11u,  12u,
+     12u,  13u,  13u,  13u,  14u,  14u,  15u,  15u,  16u,  16u,  17u,  17u,  18u,  18u,  19u,  19u,
+     20u,  20u,  21u,  22u,  22u,  23u,  23u,  24u,  25u,  25u,  26u,  26u,  27u,  28u,  28u,  29u,
+     30u,  30u,  31u,  32u,  33u,  33u,  34u,  35u,  35u,  36u,  37u,  38u,  39u,  39u,  40u,  41u,
+     42u,  43u,  43u,  44u,  45u,  46u,  47u,  48u,  49u,  49u,  50u,  51u,  52u,  53u,  54u,  55u,
+     56u,  57u,  58u,  59u,  60u,  61u,  62u,  63u,  64u,  65u,  66u,  67u,  68u,  69u,  70u,  71u,
+     73u,  74u,  75u,  76u,  77u,  78u,  79u,  81u,  82u,  83u,  84u,  85u,  87u,  88u,  89u,  90u,
+     91u,  93u,  94u,  95u,  97u,  98u,  99u, 100u, 102u, 103u, 105u, 106u, 107u, 109u, 110u, 111u,
+    113u, 114u, 116u, 117u, 119u, 120u, 121u, 123u, 124u, 126u, 127u, 129u, 130u, 132u, 133u, 135u,
+    137u, 138u, 140u, 141u, 143u, 145u, 146u, 148u, 149u, 151u, 153u, 154u, 156u, 158u, 159u, 161u,
+    163u, 165u, 166u, 168u, 170u, 172u, 173u, 175u, 177u, 179u, 181u, 182u, 184u, 186u, 188u, 190u,
+    192u, 194u, 196u, 197u, 199u, 201u, 203u, 205u, 207u, 209u, 211u, 213u, 215u, 217u, 219u, 221u,
+    223u, 225u, 227u, 229u, 231u, 234u, 236u, 238u, 240u, 242u, 244u, 246u, 248u, 251u, 253u, 255u
+};
+#endif
+
+/*******************************************************************************
+* Function Name: EncodeSerialLedColor
+********************************************************************************
+* Summary:
+* Converts a color byte to its TX_BYTES_PER_LED_COLOR bytes SPI frame. Each bit
+* of the color, MSB first, is represented by TX_BITS_PER_LED_COLOR_BIT bits,
+* LED_STATE_OFF for '0' and LED_STATE_ON for '1'.
+*
+* With SERIAL_LED_LUT_ENCODER_EN the color byte is converted with a single
+* look-up in ledEncodeTable, otherwise each color bit is converted one at a
+* time. Both encoders produce identical frames.
+*
+* Parameters:
+* color - color byte
+* txData - SPI frame, TX_BYTES_PER_LED_COLOR bytes
+*
+*******************************************************************************/
+static void EncodeSerialLedColor(uint8_t color, uint8_t * txData)
+{
+    uint32_t i;
+#if SERIAL_LED_LUT_ENCODER_EN
+    uint32_t txFrame = ledEncodeTable[color];
+#else
+    uint32_t txFrame = 0u;
+
+    for (i = 0u; i < NUM_OF_BITS_PER_COLOR; i++)
+    {
+        txFrame = (txFrame << TX_BITS_PER_LED_COLOR_BIT) | ((0u != (color & 0x80u)) ? LED_STATE_ON : LED_STATE_OFF);
+        color = (uint8_t)(color << 1u);
+    }
+#endif
+
+    /* The first transmitted byte is the most significant byte */
+    for (i = 0u; i < TX_BYTES_PER_LED_COLOR; i++)
+    {
+        txData[i] = (uint8_t)(txFrame >> ((TX_BYTES_PER_LED_COLOR - 1u - i) * 8u));
+    }
+}
+
+#if (SERIAL_LED_TX_MODE == SERIAL_LED_TX_FULL)
+/*******************************************************************************
+* Function Name: EncodeSerialLed
+********************************************************************************
+* Summary:
+* This function fills the SPI packet ledTxBuffer as per user LED data.
+* Each LED has 3 color and each color can have brightness from 0 to 255 (1 byte)
+* Each bit of LED color is represented by TX_BITS_PER_LED_COLOR_BIT bits in the
+* SPI transmission frame, LED_STATE_OFF for '0' and LED_STATE_ON for '1'. The
+* packet starts with the LED frame reset bytes.
+*
+* Parameters:
+* The pointer to the serial LED context structure serial_ledContext_t.
+*
+*******************************************************************************/
+void EncodeSerialLed(const serialLedContext_t * ptr_ledContext)
+{
+    /* ledData_t holds red, green and blue bytes in transmission order */
+    const uint8_t * colorData = (const uint8_t *)ptr_ledContext->serialLedData;
+    uint8_t * txData = &ledTxBuffer[LED_RESET_BYTES];
+    uint32_t colorIndex;
+
+    memset(ledTxBuffer, 0, LED_RESET_BYTES); /* LED frame reset byte */
+
+    for (colorIndex = 0u; colorIndex < (NUM_OF_LEDS * NUM_OF_LED_COLORS); colorIndex++)
+    {
+        EncodeSerialLedColor(colorData[colorIndex], txData);
+        txData += TX_BYTES_PER_LED_COLOR;
+    }
+}
+#elif (SERIAL_LED_TX_MODE == SERIAL_LED_TX_STREAM)
+/*******************************************************************************
+* Function Name: FillSerialLedStream
+********************************************************************************
+* Summary:
+* Called from the SPI interrupt to produce the next bytes of the LED frame
+* being sent. The colors of ledSentContext are encoded one at a time, when all
+* the bytes of the previous color have been produced.
+*
+* Parameters:
+* txData - SPI frame bytes
+* size - maximum number of bytes to produce
+*
+* Return:
+* Number of bytes produced, 0 when the whole frame is produced
+*
+*******************************************************************************/
+static uint32_t FillSerialLedStream(uint8_t * txData, uint32_t size)
+{
+    /* ledData_t holds red, green and blue bytes in transmission order */
+    const uint8_t * colorData = (const uint8_t *)ledSentContext.serialLedData;
+    uint32_t count = 0u;
+
+    while (count < size)
+    {
+        if (TX_BYTES_PER_LED_COLOR == ledStreamByte)
+        {
+            if ((NUM_OF_LEDS * NUM_OF_LED_COLORS) == ledNextColor)
+            {
+                break;
+            }
+
+            EncodeSerialLedColor(colorData[ledNextColor], ledStreamColor);
+            ledNextColor++;
+            ledStreamByte = 0u;
+        }
+
+        txData[count] = ledStreamColor[ledStreamByte];
+        ledStreamByte++;
+        count++;
+    }
+
+    return count;
+}
+#else
+/*******************************************************************************
+* Function Name: EncodeSerialLedChunk
+********************************************************************************
+* Summary:
+* Encodes the next LED_COLORS_PER_CHUNK colors of the LED frame being sent.
+*
+* Parameters:
+* txData - chunk buffer, LED_BYTES_PER_CHUNK bytes
+*
+* Return:
+* Number of bytes encoded, 0 when the whole frame is encoded
+*
+*******************************************************************************/
+static uint32_t EncodeSerialLedChunk(uint8_t * txData)
+{
+    /* ledData_t holds red, green and blue bytes in transmission order */
+    const uint8_t * colorData = (const uint8_t *)ledSentContext.serialLedData;
+    uint32_t colorEnd = ledNextColor + LED_COLORS_PER_CHUNK;
+    uint32_t size = 0u;
+
+    if (colorEnd > (NUM_OF_LEDS * NUM_OF_LED_COLORS))
+    {
+        colorEnd = NUM_OF_LEDS * NUM_OF_LED_COLORS;
+    }
+
+    for (; ledNextColor < colorEnd; ledNextColor++)
+    {
+        EncodeSerialLedColor(colorData[ledNextColor], &txData[size]);
+        size += TX_BYTES_PER_LED_COLOR;
+    }
+
+    return size;
+}
+
+/*******************************************************************************
+* Function Name: SerialLedChunkDone
+********************************************************************************
+* Summary:
+* Called from the SPI interrupt when a chunk is transmitted. Starts the chunk
+* encoded in advance and encodes the following one into the buffer just
+* transmitted, so the gap between the chunks is only the interrupt latency.
+* The data line is low during the gap, which must stay well below the LED
+* latch time (SERIAL_LED_CHUNK_GAP_NS).
+*
+*******************************************************************************/
+static void SerialLedChunkDone(void)
+{
+    if (0u == ledPendingChunkSize)
+    {
+        ledFrameActive = false;
+        return;
+    }
+
+    SendSpiPacketAsync(ledChunkBuffer[ledPendingChunk], ledPendingChunkSize);
+
+    ledPendingChunk ^= 1u;
+    ledPendingChunkSize = EncodeSerialLedChunk(ledChunkBuffer[ledPendingChunk]);
+}
+#endif
+
 /*******************************************************************************
 * Function Name: ProcessSerialLed
 ********************************************************************************
 * Summary:
-* This function creates the required data packets for the serial LEDs. 
-* Each LED has 3 color and each color can have brightness fromm 0 to 255 (1 byte)
-* Each bit of LED color is represented by 4 bits in the SPI transmission frame - 
-* '0' => '1000' and '1' => '1110'.
+* This function creates the required data packets for the serial LEDs and
+* sends them to the LEDs.
 *
 * This functions performs following:
-*  - initializes and fills the SPI packet ledTxBuffer as per user LED data,
-*  - initiates transfer of ledTxBuffer through SPI master,
-*  - clears the SPI Tx FIFO after the completion of data transfer
+*  - returns without encoding and sending if the LED data is the same as in
+*    the last frame sent, except every SERIAL_LED_REFRESH_INTERVAL frames
+*  - waits until the previous frame is transmitted
+*  - SERIAL_LED_TX_FULL: fills the SPI packet ledTxBuffer as per user LED data
+*    and initiates its transfer through SPI master
+*  - SERIAL_LED_TX_CHUNKED: encodes the first two chunks and initiates the
+*    transfer of the first one, the SPI interrupt sends the rest
+*  - SERIAL_LED_TX_STREAM: initiates the transfer, the SPI interrupt encodes
+*    the frame while it is transmitted
+*  - returns without waiting for the transfer to complete
 *
 * Parameters:
 * The pointer to the serial LED context structure serial_ledContext_t.
@@ -67,76 +319,319 @@ serialLedContext_t ledContext;
 *******************************************************************************/
 void ProcessSerialLed(serialLedContext_t * ptr_ledContext)
 {
+#if (SERIAL_LED_TX_MODE == SERIAL_LED_TX_CHUNKED)
+    uint32_t size;
+#endif
+
+    if ((ledSentContextValid) &&
+        (0 == memcmp(&ledSentContext, ptr_ledContext, sizeof(ledSentContext))))
+    {
+#if (SERIAL_LED_REFRESH_INTERVAL > 0u)
+        ledUnchangedFrameCount++;
+        if (ledUnchangedFrameCount < SERIAL_LED_REFRESH_INTERVAL)
+        {
+            return;
+        }
+#else
+        return;
+#endif
+    }
+
+    /* The transmit buffers and ledSentContext are in use until the previous
+    * frame is transmitted */
+    while (IsSerialLedBusy())
+    {
+
+    }
+
+    ledUnchangedFrameCount = 0u;
+    ledSentContext = *ptr_ledContext;
+    ledSentContextValid = true;
+
+#if (SERIAL_LED_TX_MODE == SERIAL_LED_TX_FULL)
+    EncodeSerialLed(ptr_ledContext);
+
+    /* Start sending the packet to LEDs on SPI, the SPI interrupt completes
+    * the transfer and clears the SPI transmission buffer */
+    SendSpiPacketAsync(ledTxBuffer, LED_BYTES_PER_PACKET);
+#elif (SERIAL_LED_TX_MODE == SERIAL_LED_TX_STREAM)
+    /* The reset bytes are streamed from the end of a zeroed color frame */
+    memset(ledStreamColor, 0, sizeof(ledStreamColor));
+    ledStreamByte = TX_BYTES_PER_LED_COLOR - LED_RESET_BYTES;
+    ledNextColor = 0u;
+
+    SendSpiStreamAsync(&FillSerialLedStream);
+#else
+    ledNextColor = 0u;
+
+    memset(ledChunkBuffer[0u], 0, LED_RESET_BYTES); /* LED frame reset byte */
+    size = LED_RESET_BYTES + EncodeSerialLedChunk(&ledChunkBuffer[0u][LED_RESET_BYTES]);
+
+    ledPendingChunk = 1u;
+    ledPendingChunkSize = EncodeSerialLedChunk(ledChunkBuffer[1u]);
+
+    ledFrameActive = true;
+    RegisterSpiDoneCallback(&SerialLedChunkDone);
+
+    if (CY_SCB_SPI_SUCCESS != SendSpiPacketAsync(ledChunkBuffer[0u], size))
+    {
+        ledFrameActive = false;
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: IsSerialLedBusy
+********************************************************************************
+* Summary:
+* Checks whether the LED frame started by ProcessSerialLed() is still being
+* transmitted.
+*
+* Return:
+* true while the frame transfer is in progress
+*
+*******************************************************************************/
+bool IsSerialLedBusy(void)
+{
+#if (SERIAL_LED_TX_MODE != SERIAL_LED_TX_CHUNKED)
+    return IsSpiTransferActive();
+#else
+    return ledFrameActive;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: SetSerialLedBarGraph
+********************************************************************************
+* Summary:
+* Shows a level as a bar over all the LEDs of the chain: the first
+* level * NUM_OF_LEDS / 255 LEDs are set to the color, the others are off.
+*
+* Parameters:
+* ptr_ledContext - pointer to the serial LED context structure
+* level - bar length, 0 (no LED) to 255 (all the LEDs)
+* color - color of the lit LEDs
+*
+*******************************************************************************/
+void SetSerialLedBarGraph(serialLedContext_t * ptr_ledContext, uint8_t level, const ledData_t * color)
+{
+    /* Rounds up, so any non-zero level lights at least one LED */
+    uint32_t litLeds = ((uint32_t)level * NUM_OF_LEDS + 255u) >> 8u;
+    uint32_t ledIndex;
+
+    for (ledIndex = 0u; ledIndex < NUM_OF_LEDS; ledIndex++)
+    {
+        if (ledIndex < litLeds)
+        {
+            ptr_ledContext->serialLedData[ledIndex] = *color;
+        }
+        else
+        {
+            memset(&ptr_ledContext->serialLedData[ledIndex], 0, sizeof(ledData_t));
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: StartLedAnimationFade
+********************************************************************************
+* Summary:
+* Starts a linear fade of an animation from its current level to the target
+* color. The per step change of each color is computed here once, so that
+* StepLedAnimation() only adds it.
+*
+* Parameters:
+* animation - LED animation
+* target - color at the end of the fade
+* steps - fade length in frame steps, at least 1
+*
+*******************************************************************************/
+static void StartLedAnimationFade(ledAnimation_t * animation, const ledData_t * target, uint32_t steps)
+{
+    const uint8_t * targetColor = (const uint8_t *)target;
+    uint32_t i;
+
+    if (0u == steps)
+    {
+        steps = 1u;
+    }
+    if (steps > UINT16_MAX)
+    {
+        steps = UINT16_MAX;
+    }
+
+    animation->target = *target;
+    animation->stepsLeft = (uint16_t)steps;
+
+    for (i = 0u; i < NUM_OF_LED_COLORS; i++)
+    {
+        int32_t diff = ((int32_t)targetColor[i] << LED_ANIMATION_FRAC_BITS) - (int32_t)animation->level[i];
+
+        /* A single step fade jumps to the target and needs no step */
+        animation->step[i] = (steps > 1u) ? (int16_t)(diff / (int32_t)steps) : 0;
+    }
+}
+
+/*******************************************************************************
+* Function Name: StartLedFade
+********************************************************************************
+* Summary:
+* Fades a LED from its current color to the target color, e.g. fade-in to a
+* color or fade-out to off. A LED not animated before starts from off, a LED
+* animated before starts from its last animated color. Once the target color
+* is reached the LED keeps it until the next animation or StopLedAnimation().
+*
+* Parameters:
+* ledIndex - LED index, LED1 to NUM_OF_LEDS - 1
+* target - color at the end of the fade
+* frames - fade length in ACTIVE mode frames
+*
+*******************************************************************************/
+void StartLedFade(uint32_t ledIndex, const ledData_t * target, uint32_t frames)
+{
+    ledAnimation_t * animation = &ledAnimation[ledIndex];
+
+    StartLedAnimationFade(animation, target, frames);
+    animation->mode = LED_ANIMATION_FADE;
+}
+
+/*******************************************************************************
+* Function Name: StartLedBreathing
+********************************************************************************
+* Summary:
+* Fades a LED repeatedly from its current color to the peak color, from the
+* peak color to off and back, until another animation is started or
+* StopLedAnimation() is called.
+*
+* Parameters:
+* ledIndex - LED index, LED1 to NUM_OF_LEDS - 1
+* color - peak color
+* halfPeriod - length of each fade in ACTIVE mode frames
+*
+*******************************************************************************/
+void StartLedBreathing(uint32_t ledIndex, const ledData_t * color, uint32_t halfPeriod)
+{
+    ledAnimation_t * animation = &ledAnimation[ledIndex];
 
-    uint8_t i, ledIndex, colorIndex, ledByte, nibbleIndex, bufferIndex = 1u;
+    if (0u == halfPeriod)
+    {
+        halfPeriod = 1u;
+    }
+    if (halfPeriod > UINT16_MAX)
+    {
+        halfPeriod = UINT16_MAX;
+    }
 
-    /* Clear Tx buffer */
-    ledTxBuffer[0u] = 0u; /* LED frame reset byte */
-    ledTxBuffer[1u] = 0u;
+    animation->peak = *color;
+    animation->halfPeriod = (uint16_t)halfPeriod;
 
-    /* Process for each LED */
-    for(ledIndex = 0u; ledIndex < NUM_OF_LEDS; ledIndex++)
+    StartLedAnimationFade(animation, color, halfPeriod);
+    animation->mode = LED_ANIMATION_BREATHE;
+}
+
+/*******************************************************************************
+* Function Name: StopLedAnimation
+********************************************************************************
+* Summary:
+* Stops the animation of a LED, StepLedAnimation() no longer sets its color.
+*
+* Parameters:
+* ledIndex - LED index, LED1 to NUM_OF_LEDS - 1
+*
+*******************************************************************************/
+void StopLedAnimation(uint32_t ledIndex)
+{
+    ledAnimation[ledIndex].mode = LED_ANIMATION_NONE;
+}
+
+/*******************************************************************************
+* Function Name: StepLedAnimation
+********************************************************************************
+* Summary:
+* Advances the LED animations and sets the color of each animated LED. To be
+* called once per frame before ProcessSerialLed(), with the frame length in
+* ACTIVE mode frames, so that the animations keep their speed at any refresh
+* rate and without wake ups of their own.
+*
+* A fade adds its precomputed step per frame and ends exactly on the target
+* color. The LED data does not change afterwards, so ProcessSerialLed() stops
+* sending frames until the next animation.
+*
+* Parameters:
+* ptr_ledContext - pointer to the serial LED context structure
+* steps - frame steps elapsed since the previous call
+*
+* Return:
+* true while any LED is fading or breathing
+*
+*******************************************************************************/
+bool StepLedAnimation(serialLedContext_t * ptr_ledContext, uint32_t steps)
+{
+    bool animating = false;
+    uint32_t ledIndex;
+    uint32_t i;
+
+    for (ledIndex = 0u; ledIndex < NUM_OF_LEDS; ledIndex++)
     {
-        /* Process each colors */
-        for(colorIndex = 0u; colorIndex < NUM_OF_LED_COLORS; colorIndex++)
+        ledAnimation_t * animation = &ledAnimation[ledIndex];
+        uint8_t * color = (uint8_t *)&ptr_ledContext->serialLedData[ledIndex];
+        uint32_t stepsLeft = steps;
+
+        if (LED_ANIMATION_NONE == animation->mode)
         {
-            if(colorIndex == 0u)
-            {
-                /* Process the red color data*/
-                ledByte = ptr_ledContext->serialLedData[ledIndex].red;
-            }
-            else if (colorIndex == 1u)
+            continue;
+        }
+
+        while ((0u != stepsLeft) && (LED_ANIMATION_HOLD != animation->mode))
+        {
+            if (stepsLeft < animation->stepsLeft)
             {
-                /* Process the green color data*/
-                ledByte = ptr_ledContext->serialLedData[ledIndex].green;
+                for (i = 0u; i < NUM_OF_LED_COLORS; i++)
+                {
+                    animation->level[i] = (uint16_t)((int32_t)animation->level[i] +
+                                                     ((int32_t)animation->step[i] * (int32_t)stepsLeft));
+                }
+                animation->stepsLeft -= (uint16_t)stepsLeft;
+                stepsLeft = 0u;
             }
             else
             {
-                /* Process the blue color data*/
-                ledByte = ptr_ledContext->serialLedData[ledIndex].blue;
-            }
-            
-            nibbleIndex = 0u;
+                /* End of the fade, the rounding error of the steps is dropped */
+                const uint8_t * targetColor = (const uint8_t *)&animation->target;
 
-            /* Convert each data bit into LED data frame nibble: '0' => '1000' and '1' => '1110' */
-            /* Process a byte at a time */
-            for (i = 0u; i < 8u; i++)
-            {
-                if (ledByte & 0x80)
-                {
-                    ledTxBuffer[bufferIndex] =  ledTxBuffer[bufferIndex] + LED_STATE_ON; 
-                }
-                else
+                stepsLeft -= animation->stepsLeft;
+                for (i = 0u; i < NUM_OF_LED_COLORS; i++)
                 {
-                    ledTxBuffer[bufferIndex] =  ledTxBuffer[bufferIndex] +  LED_STATE_OFF; 
+                    animation->level[i] = (uint16_t)((uint32_t)targetColor[i] << LED_ANIMATION_FRAC_BITS);
                 }
 
-                /* Move the first nibble to MSB side*/
-                if (nibbleIndex == 0u)
+                if (LED_ANIMATION_BREATHE == animation->mode)
                 {
-                    ledTxBuffer[bufferIndex] = ledTxBuffer[bufferIndex] << 4u;
+                    ledData_t off = {0u, 0u, 0u};
+
+                    StartLedAnimationFade(animation,
+                                          (0 == memcmp(&animation->target, &animation->peak, sizeof(ledData_t))) ?
+                                          &off : &animation->peak,
+                                          animation->halfPeriod);
                 }
-                /* Each bit of LED color is represented by 4 bits in the transmission frame;
-                Point to next byte in the Tx buffer byte array, if 2 color bits (1 tx buffer byte) 
-                are processed  */
-                nibbleIndex++;
-                
-                if (nibbleIndex > 1u)
+                else
                 {
-                    nibbleIndex = 0u;
-                    bufferIndex++;
-
-                    /* Clear next byte of the buffer */
-                    ledTxBuffer[bufferIndex] = 0u;
+                    animation->mode = LED_ANIMATION_HOLD;
                 }
-                /* Process next bit */
-                ledByte = ledByte << 1u;
             }
         }
+
+        for (i = 0u; i < NUM_OF_LED_COLORS; i++)
+        {
+            color[i] = (uint8_t)(animation->level[i] >> LED_ANIMATION_FRAC_BITS);
+        }
+
+        if (LED_ANIMATION_HOLD != animation->mode)
+        {
+            animating = true;
+        }
     }
-    /* Send the packet to LEDs on SPI */
-    SendSpiPacket(ledTxBuffer, LED_BYTES_PER_PACKET);
-    /* Clear SPI transmission buffer */
-    Cy_SCB_SPI_ClearTxFifo(CYBSP_MASTER_SPI_HW);
+
+    return animating;
 }
 /* [] END OF FILE */
@@ -43,14 +43,61 @@
 /*******************************************************************************
 * Macros
 *******************************************************************************/
+/* Number of serial LEDs in the chain */
+#ifndef NUM_OF_LEDS
 #define NUM_OF_LEDS                 (3u)
+#endif
 #define NUM_OF_LED_COLORS           (3u)
 #define NUM_OF_BITS_PER_COLOR       (8u)
 
+/* SPI data rate of the serial LED SCB in bits per second, from the SCB clock
+* and oversampling in user_spi.h */
+#define SERIAL_LED_SPI_BIT_RATE     (SPI_BIT_RATE)
+
+/* Number of SPI bits transmitted for each bit of LED color, 2 to 4. The LED
+* bit period is this number of SPI bit times, e.g. 3 bits at 2.4 Mbps or 4 bits
+* at 3.2 Mbps */
+#ifndef SERIAL_LED_TX_BITS_PER_BIT
+#define SERIAL_LED_TX_BITS_PER_BIT  (4u)
+#endif
+
+/* Timing of the serial LED in ns, from its datasheet: high time of a '0' and a
+* '1' bit, allowed deviation of the high times, and bit period range */
+#define SERIAL_LED_T0H_NS           (300u)
+#define SERIAL_LED_T1H_NS           (900u)
+#define SERIAL_LED_TH_TOLERANCE_NS  (150u)
+#define SERIAL_LED_BIT_MIN_NS       (650u)
+#define SERIAL_LED_BIT_MAX_NS       (1850u)
+
+/* Shortest low time in ns on the LED data line that latches the LED colors,
+* the reset time of the LED datasheet: 50 us for the older and 280 us for the
+* newer parts of this LED type. A low time this long within a frame latches a
+* partial frame; the next frame must not start earlier after a frame */
+#ifndef SERIAL_LED_LATCH_NS
+#define SERIAL_LED_LATCH_NS         (50000u)
+#endif
+
+/* Low time in ns sent before each frame, so the SPI MOSI starts the frame at
+* a defined low level. This is not the latch time, the frames are latched by
+* the idle time between them */
+#define SERIAL_LED_LEAD_IN_NS       (2000u)
+
+/* SPI bits of a duration in ns, rounded to the nearest and rounded up, and the
+* duration of a number of SPI bits in ns */
+#define SERIAL_LED_SPI_KHZ          (SERIAL_LED_SPI_BIT_RATE / 1000u)
+#define LED_NS_TO_SPI_BITS(ns)      ((((ns) * SERIAL_LED_SPI_KHZ) + 500000u) / 1000000u)
+#define LED_NS_TO_SPI_BITS_UP(ns)   ((((ns) * SERIAL_LED_SPI_KHZ) + 999999u) / 1000000u)
+#define LED_SPI_BITS_TO_NS(bits)    (((bits) * 1000000u) / SERIAL_LED_SPI_KHZ)
+
 /* Number of bits to be transmitted on SPI for each bit of LED color */
-#define TX_BITS_PER_LED_COLOR_BIT   (4u)
+#define TX_BITS_PER_LED_COLOR_BIT   (SERIAL_LED_TX_BITS_PER_BIT)
 
-#define LED_RESET_INTERVAL_BITS     (8u)
+/* High SPI bits of a '0' and a '1' LED bit */
+#define LED_T0H_BITS                (LED_NS_TO_SPI_BITS(SERIAL_LED_T0H_NS))
+#define LED_T1H_BITS                (LED_NS_TO_SPI_BITS(SERIAL_LED_T1H_NS))
+
+/* Low lead-in SPI bits before each frame, whole bytes */
+#define LED_RESET_INTERVAL_BITS     (((LED_NS_TO_SPI_BITS_UP(SERIAL_LED_LEAD_IN_NS) + 7u) / 8u) * 8u)
 
 /* Number of bits to be transmitted on SPI for each LED color*/
 #define TX_BITS_PER_LED_COLOR       (NUM_OF_BITS_PER_COLOR * TX_BITS_PER_LED_COLOR_BIT)
@@ -58,11 +105,112 @@
 /* Number of bits to be transmitted on SPI for each LED (all 3 colors)*/
 #define TX_BITS_PER_LED             (NUM_OF_LED_COLORS * TX_BITS_PER_LED_COLOR)
 
-/* Number of bytes per packets to be transmitted on SPI for all 3 LEDs*/
+/* Number of bytes per packets to be transmitted on SPI for all the LEDs*/
 #define LED_BYTES_PER_PACKET        (((TX_BITS_PER_LED * NUM_OF_LEDS) + LED_RESET_INTERVAL_BITS))/(8u)
 
-#define LED_STATE_OFF               (8u)
-#define LED_STATE_ON                (14u)
+/* Number of bytes to be transmitted on SPI for each LED color and for the LED
+* frame reset */
+#define TX_BYTES_PER_LED_COLOR      (TX_BITS_PER_LED_COLOR / 8u)
+#define LED_RESET_BYTES             (LED_RESET_INTERVAL_BITS / 8u)
+
+/* SPI frame buffering of the LED frame:
+* SERIAL_LED_TX_FULL    - the whole frame is encoded into ledTxBuffer, then sent
+* SERIAL_LED_TX_CHUNKED - the frame is encoded SERIAL_LED_CHUNK_LEDS LEDs at a
+*                         time into two chunk buffers. The SPI interrupt sends
+*                         one chunk while the next one is encoded
+* SERIAL_LED_TX_STREAM  - no frame buffer, the SPI interrupt encodes the next
+*                         bytes as the SPI Tx FIFO drains */
+#define SERIAL_LED_TX_FULL          (0u)
+#define SERIAL_LED_TX_CHUNKED       (1u)
+#define SERIAL_LED_TX_STREAM        (2u)
+
+/* SPI bit patterns of a '0' and a '1' LED bit, the high bits first, e.g.
+* '1000' (8) and '1110' (14) with 4 bits at 3.2 Mbps */
+#define LED_STATE_OFF               (((1u << LED_T0H_BITS) - 1u) << (TX_BITS_PER_LED_COLOR_BIT - LED_T0H_BITS))
+#define LED_STATE_ON                (((1u << LED_T1H_BITS) - 1u) << (TX_BITS_PER_LED_COLOR_BIT - LED_T1H_BITS))
+
+#if ((TX_BITS_PER_LED_COLOR_BIT < 2u) || (TX_BITS_PER_LED_COLOR_BIT > 4u))
+    #error "SERIAL_LED_TX_BITS_PER_BIT must be 2 to 4, the SPI frame of a color byte is at most 32 bits"
+#endif
+
+#if ((LED_T0H_BITS < 1u) || (LED_T1H_BITS <= LED_T0H_BITS) || (LED_T1H_BITS >= TX_BITS_PER_LED_COLOR_BIT))
+    #error "SERIAL_LED_SPI_BIT_RATE cannot encode the LED high times in SERIAL_LED_TX_BITS_PER_BIT bits"
+#endif
+
+#if ((LED_SPI_BITS_TO_NS(LED_T0H_BITS) + SERIAL_LED_TH_TOLERANCE_NS < SERIAL_LED_T0H_NS) || \
+     (LED_SPI_BITS_TO_NS(LED_T0H_BITS) > SERIAL_LED_T0H_NS + SERIAL_LED_TH_TOLERANCE_NS) || \
+     (LED_SPI_BITS_TO_NS(LED_T1H_BITS) + SERIAL_LED_TH_TOLERANCE_NS < SERIAL_LED_T1H_NS) || \
+     (LED_SPI_BITS_TO_NS(LED_T1H_BITS) > SERIAL_LED_T1H_NS + SERIAL_LED_TH_TOLERANCE_NS))
+    #error "The LED high times at SERIAL_LED_SPI_BIT_RATE are out of SERIAL_LED_TH_TOLERANCE_NS"
+#endif
+
+#if ((LED_SPI_BITS_TO_NS(TX_BITS_PER_LED_COLOR_BIT) < SERIAL_LED_BIT_MIN_NS) || \
+     (LED_SPI_BITS_TO_NS(TX_BITS_PER_LED_COLOR_BIT) > SERIAL_LED_BIT_MAX_NS))
+    #error "The LED bit period at SERIAL_LED_SPI_BIT_RATE is out of the SERIAL_LED_BIT_MIN_NS to SERIAL_LED_BIT_MAX_NS range"
+#endif
+
+/* SPI frame of a color byte: every color bit, MSB first, replaced by its
+* LED_STATE_ON or LED_STATE_OFF pattern, the first bit in the most significant
+* bits of the TX_BITS_PER_LED_COLOR bit frame */
+#define LED_ENCODE_BIT(color, bit)  (((0u != ((color) & (1u << (bit)))) ? LED_STATE_ON : LED_STATE_OFF) << \
+                                    ((bit) * TX_BITS_PER_LED_COLOR_BIT))
+#define LED_ENCODE_COLOR(color)     (LED_ENCODE_BIT((color), 7u) | LED_ENCODE_BIT((color), 6u) | \
+                                     LED_ENCODE_BIT((color), 5u) | LED_ENCODE_BIT((color), 4u) | \
+                                     LED_ENCODE_BIT((color), 3u) | LED_ENCODE_BIT((color), 2u) | \
+                                     LED_ENCODE_BIT((color), 1u) | LED_ENCODE_BIT((color), 0u))
+
+/* LED frame encoder selection: 1 - 256-entry flash look-up table (one lookup
+* per color byte), 0 - bitwise encoder (one branch per color bit) */
+#ifndef SERIAL_LED_LUT_ENCODER_EN
+#define SERIAL_LED_LUT_ENCODER_EN   (1u)
+#endif
+
+/* Enable this, to map LED brightness through a perceptual (gamma 2.2) table,
+* so that equal brightness steps look equally large */
+#ifndef SERIAL_LED_GAMMA_EN
+#define SERIAL_LED_GAMMA_EN         (0u)
+#endif
+
+/* Number of consecutive unchanged frames after which the LED frame is sent
+* again to recover from a corrupted frame. 0 - unchanged frames are never sent */
+#define SERIAL_LED_REFRESH_INTERVAL (128u)
+
+/* Number of LEDs encoded per chunk in SERIAL_LED_TX_CHUNKED mode */
+#define SERIAL_LED_CHUNK_LEDS       (4u)
+
+/* Longest low time in ns on the LED data line between two chunks in
+* SERIAL_LED_TX_CHUNKED mode: the SPI interrupt latency, the SPI driver and
+* the start of the next chunk. An estimate of about 500 CPU cycles at 48 MHz
+* with the SPI interrupt at the highest priority; critical sections of the
+* application add to it. Check it on the LED data line, some LEDs latch on
+* lower times than their datasheet states */
+#ifndef SERIAL_LED_CHUNK_GAP_NS
+#define SERIAL_LED_CHUNK_GAP_NS     (10500u)
+#endif
+
+/* LED frame buffering, chunked when the full frame needs more SRAM than the
+* two chunk buffers. SERIAL_LED_TX_STREAM needs no buffer, but keeps the SPI
+* interrupt busy for the whole frame */
+#ifndef SERIAL_LED_TX_MODE
+#define SERIAL_LED_TX_MODE          ((NUM_OF_LEDS > (2u * SERIAL_LED_CHUNK_LEDS)) ? \
+                                    SERIAL_LED_TX_CHUNKED : SERIAL_LED_TX_FULL)
+#endif
+
+/* Number of bytes of a chunk and number of LED colors per chunk */
+#define LED_COLORS_PER_CHUNK        (SERIAL_LED_CHUNK_LEDS * NUM_OF_LED_COLORS)
+#define LED_BYTES_PER_CHUNK         (LED_COLORS_PER_CHUNK * TX_BYTES_PER_LED_COLOR)
+
+/* The chunk gap needs a margin of 2 to the latch time */
+#if ((SERIAL_LED_TX_MODE == SERIAL_LED_TX_CHUNKED) && ((2u * SERIAL_LED_CHUNK_GAP_NS) >= SERIAL_LED_LATCH_NS))
+    #error "The gap between the LED chunks can latch a partial LED frame, see SERIAL_LED_CHUNK_GAP_NS"
+#endif
+
+#if ((SERIAL_LED_TX_MODE == SERIAL_LED_TX_STREAM) && (LED_RESET_BYTES > TX_BYTES_PER_LED_COLOR))
+    #error "SERIAL_LED_TX_STREAM streams at most TX_BYTES_PER_LED_COLOR reset bytes"
+#endif
+
+/* Fraction bits of the LED animation color levels and steps */
+#define LED_ANIMATION_FRAC_BITS     (8u)
 
 #define LED1                        (0u)
 #define LED2                        (1u)
@@ -78,6 +226,26 @@ typedef struct ledData
     uint8_t blue;
 } ledData_t;
 
+/* LED animation of one LED */
+typedef enum
+{
+    LED_ANIMATION_NONE = 0u,    /* LED not animated, the application sets its color */
+    LED_ANIMATION_HOLD,         /* Animation complete, the LED keeps its last color */
+    LED_ANIMATION_FADE,         /* Linear fade to the target color */
+    LED_ANIMATION_BREATHE       /* Repeated fades between the peak color and off */
+} ledAnimationMode_t;
+
+typedef struct ledAnimation
+{
+    uint16_t level[NUM_OF_LED_COLORS];  /* Current color, LED_ANIMATION_FRAC_BITS fixed point */
+    int16_t step[NUM_OF_LED_COLORS];    /* Color change per frame step, same fixed point */
+    ledData_t target;                   /* Color at the end of the fade */
+    ledData_t peak;                     /* Breathing color */
+    uint16_t stepsLeft;                 /* Frame steps to the target color */
+    uint16_t halfPeriod;                /* Breathing fade length in frame steps */
+    uint8_t mode;                       /* ledAnimationMode_t */
+} ledAnimation_t;
+
 /* serial LED context structure  */
 typedef struct serialLedContext
 {
@@ -88,7 +256,20 @@ typedef struct serialLedContext
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
+#if SERIAL_LED_GAMMA_EN
+extern const uint8_t ledGammaTable[256u];
+#endif
+
+#if (SERIAL_LED_TX_MODE == SERIAL_LED_TX_FULL)
+void EncodeSerialLed(const serialLedContext_t *);
+#endif
 void ProcessSerialLed(serialLedContext_t *);
+bool IsSerialLedBusy(void);
+void SetSerialLedBarGraph(serialLedContext_t *, uint8_t, const ledData_t *);
+void StartLedFade(uint32_t, const ledData_t *, uint32_t);
+void StartLedBreathing(uint32_t, const ledData_t *, uint32_t);
+void StopLedAnimation(uint32_t);
+bool StepLedAnimation(serialLedContext_t *, uint32_t);
 
 #endif /* SOURCE_USER_LED_CONTROL_H_ */
 
@@ -0,0 +1,85 @@
+/******************************************************************************
+* File Name: user_marker.h
+*
+* Description: This file contains the macros of the GPIO timestamp markers.
+*
+*******************************************************************************
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_USER_MARKER_H_
+#define SOURCE_USER_MARKER_H_
+
+#include "cy_pdl.h"
+#include "cybsp.h"
+
+/*******************************************************************************
+* User configurable Macros
+*******************************************************************************/
+/* Enable this, to toggle a spare GPIO at the scan start, the scan complete
+* interrupt, the end of the processing, the end of the LED frame transfer and
+* the WOT to ACTIVE mode transition, to measure the latency and the duty cycle
+* with a logic analyzer. Each marker is a single write to the port DR_INV
+* register. Name a spare pin MARKER in the Device Configurator, with the
+* strong drive mode and the initial state low */
+#ifndef ENABLE_GPIO_MARKERS
+#define ENABLE_GPIO_MARKERS         (0u)
+#endif
+
+#if ENABLE_GPIO_MARKERS
+#ifndef CYBSP_MARKER_PORT
+    #error "ENABLE_GPIO_MARKERS needs a spare pin named MARKER in the Device Configurator"
+#endif
+
+/* Pins of the MARKER port toggled by each marker. All the markers use the
+* MARKER pin by default. Other pins of the same port, set up in the Device
+* Configurator, separate the markers on the logic analyzer */
+#define MARKER_PIN_MSK              (1UL << CYBSP_MARKER_NUM)
+#define MARKER_SCAN_START_MSK       (MARKER_PIN_MSK)
+#define MARKER_SCAN_DONE_MSK        (MARKER_PIN_MSK)
+#define MARKER_PROCESS_DONE_MSK     (MARKER_PIN_MSK)
+#define MARKER_LED_SENT_MSK         (MARKER_PIN_MSK)
+#define MARKER_WOT_WAKE_MSK         (MARKER_PIN_MSK)
+#endif
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#if ENABLE_GPIO_MARKERS
+    #define MARKER_TOGGLE(marker)   (GPIO_PRT_DR_INV(CYBSP_MARKER_PORT) = MARKER_##marker##_MSK)
+#else
+    #define MARKER_TOGGLE(marker)
+#endif
+
+#endif /* SOURCE_USER_MARKER_H_ */
+
+/* [] END OF FILE */
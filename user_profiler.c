@@ -0,0 +1,159 @@
+/*******************************************************************************
+ * File Name:   user_profiler.c
+ *
+ * Description: This file contains the per-stage run time profiler. It records
+ *              the CPU cycles of each main loop stage into a ring buffer and
+ *              keeps min/max/average statistics per stage.
+ *
+ *******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+ ******************************************************************************/
+
+#include <string.h>
+#include "user_profiler.h"
+
+#if ENABLE_PROFILER
+
+/*******************************************************************************
+* Global Definitions
+*******************************************************************************/
+/* Profiler data, placed in the host interface */
+static profilerData_t * profilerData = NULL;
+
+/* SysTick value at the start of each stage */
+static uint32_t stageStartTicks[PROFILER_STAGE_NUM];
+
+/*******************************************************************************
+* Function Name: InitProfiler
+********************************************************************************
+* Summary:
+* Sets and clears the profiler data. SysTick must be running from the CPU clock
+* with the maximum reload value.
+*
+* Parameters:
+* data - pointer to the profiler data
+*
+*******************************************************************************/
+void InitProfiler(profilerData_t * data)
+{
+    uint32_t stage;
+
+    memset(data, 0, sizeof(*data));
+
+    data->version = PROFILER_DATA_VERSION;
+    data->stageNum = (uint8_t)PROFILER_STAGE_NUM;
+    data->ringSize = (uint8_t)PROFILER_RING_SIZE;
+
+    for (stage = 0u; stage < (uint32_t)PROFILER_STAGE_NUM; stage++)
+    {
+        data->stats[stage].minCycles = PROFILER_SAMPLE_CYCLES_MSK;
+    }
+
+    profilerData = data;
+}
+
+/*******************************************************************************
+* Function Name: ProfilerStart
+********************************************************************************
+* Summary:
+* Marks the start of a stage.
+*
+* Parameters:
+* stage - profiled stage
+*
+*******************************************************************************/
+void ProfilerStart(profilerStage_t stage)
+{
+    stageStartTicks[stage] = Cy_SysTick_GetValue();
+}
+
+/*******************************************************************************
+* Function Name: ProfilerStop
+********************************************************************************
+* Summary:
+* Marks the end of a stage, adds the elapsed CPU cycles to the ring buffer and
+* updates the stage statistics. Can be called from an interrupt.
+*
+* Parameters:
+* stage - profiled stage
+*
+*******************************************************************************/
+void ProfilerStop(profilerStage_t stage)
+{
+    uint32_t interruptStatus;
+    uint32_t cycles;
+    profilerStageStats_t * stats;
+
+    if (NULL == profilerData)
+    {
+        return;
+    }
+    stats = &profilerData->stats[stage];
+
+    /* SysTick counts down and wraps at 24 bits */
+    cycles = (stageStartTicks[stage] - Cy_SysTick_GetValue()) & PROFILER_SAMPLE_CYCLES_MSK;
+
+    interruptStatus = Cy_SysLib_EnterCriticalSection();
+
+    profilerData->ring[profilerData->ringHead] = ((uint32_t)stage << PROFILER_SAMPLE_STAGE_POS) | cycles;
+    profilerData->ringHead++;
+    if (PROFILER_RING_SIZE <= profilerData->ringHead)
+    {
+        profilerData->ringHead = 0u;
+    }
+
+    if (cycles < stats->minCycles)
+    {
+        stats->minCycles = cycles;
+    }
+    if (cycles > stats->maxCycles)
+    {
+        stats->maxCycles = cycles;
+    }
+
+    if (0u == stats->count)
+    {
+        stats->avgCycles = cycles;
+    }
+    else
+    {
+        stats->avgCycles = (uint32_t)((int32_t)stats->avgCycles +
+                            ((int32_t)(cycles - stats->avgCycles) >> PROFILER_AVG_SHIFT));
+    }
+    stats->count++;
+
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+}
+
+#endif /* ENABLE_PROFILER */
+
+/* [] END OF FILE */
@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name: user_profiler.h
+*
+* Description: This file contains the macros, data types and function
+*              prototypes of the per-stage run time profiler.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_USER_PROFILER_H_
+#define SOURCE_USER_PROFILER_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* User configurable Macros
+*******************************************************************************/
+/* Enable this, to record the CPU cycles of each main loop stage. Uses SysTick,
+* which does not count in Deep Sleep, so only CPU active and Sleep time is
+* recorded */
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER             (0u)
+#endif
+
+/* Number of samples in the profiler ring buffer */
+#define PROFILER_RING_SIZE          (16u)
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Layout version of profilerData_t, incremented on every layout change */
+#define PROFILER_DATA_VERSION       (2u)
+
+/* Ring buffer sample: stage in bits 31:24, CPU cycles in bits 23:0 */
+#define PROFILER_SAMPLE_STAGE_POS   (24u)
+#define PROFILER_SAMPLE_CYCLES_MSK  (0x00FFFFFFu)
+
+/* Weight of a new sample in the moving average is 1/2^PROFILER_AVG_SHIFT */
+#define PROFILER_AVG_SHIFT          (4u)
+
+#if ENABLE_PROFILER
+    #define PROFILER_START(stage)   ProfilerStart(stage)
+    #define PROFILER_STOP(stage)    ProfilerStop(stage)
+#else
+    #define PROFILER_START(stage)
+    #define PROFILER_STOP(stage)
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+/* Profiled stages of the main loop. The wait for the scan completion is not
+* profiled, the CPU waits in Deep Sleep where SysTick does not count */
+typedef enum
+{
+    PROFILER_STAGE_PROCESS_WIDGETS = 0u, /* Cy_CapSense_ProcessAllWidgets() */
+    PROFILER_STAGE_UPDATE_LEDS,         /* UpdateLeds() */
+    PROFILER_STAGE_PROCESS_SERIAL_LED,  /* ProcessSerialLed() */
+    PROFILER_STAGE_SEND_SPI_PACKET,     /* SPI transfer of a LED frame */
+    PROFILER_STAGE_RUN_TUNER,           /* Cy_CapSense_RunTuner() */
+    PROFILER_STAGE_WOT_PROCESS,         /* Low power widget processing in WOT mode */
+    PROFILER_STAGE_NUM
+} profilerStage_t;
+
+/* Statistics of a stage in CPU cycles */
+typedef struct profilerStageStats
+{
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t avgCycles;     /* Moving average */
+    uint32_t count;         /* Number of samples */
+} profilerStageStats_t;
+
+/* Profiler data, exposed in the host interface on the EZI2C secondary slave address */
+typedef struct profilerData
+{
+    uint8_t version;        /* PROFILER_DATA_VERSION */
+    uint8_t stageNum;       /* PROFILER_STAGE_NUM */
+    uint8_t ringSize;       /* PROFILER_RING_SIZE */
+    uint8_t ringHead;       /* Index of the next sample to be written */
+    profilerStageStats_t stats[PROFILER_STAGE_NUM];
+    uint32_t ring[PROFILER_RING_SIZE];
+} profilerData_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void InitProfiler(profilerData_t *);
+void ProfilerStart(profilerStage_t);
+void ProfilerStop(profilerStage_t);
+
+#endif /* SOURCE_USER_PROFILER_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,203 @@
+/*******************************************************************************
+ * File Name:   user_report.c
+ *
+ * Description: This file contains the batched host reporting. It aggregates
+ *              the sensor status of several frames into the records of a
+ *              FIFO read by the host, and drives the host notify pin.
+ *
+ *******************************************************************************
+ *******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+ ******************************************************************************/
+
+
+#include <string.h>
+#include "cycfg_capsense.h"
+#include "user_report.h"
+
+#if ENABLE_BATCHED_REPORT
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define REPORT_US_PER_MS            (1000u)
+
+/* Sensor status bits of the proximity sensor, proximity and touch */
+#define REPORT_PROX_STATUS_MSK      (0x03u)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void WriteReportRecord(void);
+
+/*******************************************************************************
+* Global Definitions
+*******************************************************************************/
+/* Report data, placed in the host interface */
+static reportData_t * reportData = NULL;
+
+/* Record aggregating the current frames, written when closed */
+static reportRecord_t openRecord;
+
+/* Sensor status of the previous frame */
+static uint32_t lastSensorStatus = 0u;
+
+/* Time since boot, in ms and the remaining us */
+static uint32_t uptimeMs = 0u;
+static uint32_t uptimeUs = 0u;
+
+#if ENABLE_REPORT_NOTIFY
+/* Records written since the last host read */
+static uint32_t unreadRecordCount = 0u;
+#endif
+
+/*******************************************************************************
+* Function Name: InitReport
+********************************************************************************
+* Summary:
+* Sets and clears the report data.
+*
+* Parameters:
+* data - pointer to the report data
+*
+*******************************************************************************/
+void InitReport(reportData_t * data)
+{
+    memset(data, 0, sizeof(*data));
+
+    data->version = REPORT_DATA_VERSION;
+    data->recordSize = (uint8_t)sizeof(reportRecord_t);
+    data->recordNum = REPORT_RECORD_NUM;
+    data->framesPerRecord = REPORT_FRAMES_PER_RECORD;
+
+    memset(&openRecord, 0, sizeof(openRecord));
+    reportData = data;
+}
+
+/*******************************************************************************
+* Function Name: ReportFrame
+********************************************************************************
+* Summary:
+* Aggregates the sensor status of the current frame. Called once per frame. The
+* open record is written after REPORT_FRAMES_PER_RECORD frames, or before a
+* frame that changes the sensor status, which starts a new record marked with
+* REPORT_STATUS_EVENT.
+*
+* Parameters:
+* appState - current application state
+* framePeriod - period of the frame in us
+* hostRead - the host read the secondary slave address since the last frame
+*
+*******************************************************************************/
+void ReportFrame(uint8_t appState, uint32_t framePeriod, bool hostRead)
+{
+    const cy_stc_capsense_sensor_context_t * prox = &cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID];
+    const cy_stc_capsense_sensor_context_t * lp = &cy_capsense_tuner.sensorContext[CY_CAPSENSE_LOWPOWER0_SNS0_ID];
+    uint32_t sensorStatus;
+    bool event;
+
+    if (NULL == reportData)
+    {
+        return;
+    }
+
+#if ENABLE_REPORT_NOTIFY
+    if (hostRead)
+    {
+        unreadRecordCount = 0u;
+        Cy_GPIO_Clr(CYBSP_HOST_NOTIFY_PORT, CYBSP_HOST_NOTIFY_NUM);
+    }
+#else
+    (void)hostRead;
+#endif
+
+    sensorStatus = (prox->status & REPORT_PROX_STATUS_MSK) |
+                   ((0u != (lp->status & REPORT_PROX_STATUS_MSK)) ? REPORT_STATUS_LP : 0u);
+    event = (sensorStatus != lastSensorStatus);
+    lastSensorStatus = sensorStatus;
+
+    if (event && (0u != openRecord.frameNum))
+    {
+        WriteReportRecord();
+    }
+
+    if (0u == openRecord.frameNum)
+    {
+        openRecord.timestamp = uptimeMs;
+        openRecord.status = event ? REPORT_STATUS_EVENT : 0u;
+    }
+
+    openRecord.frameNum++;
+    openRecord.proxPeakDiff = (prox->diff > openRecord.proxPeakDiff) ? prox->diff : openRecord.proxPeakDiff;
+    openRecord.lpPeakDiff = (lp->diff > openRecord.lpPeakDiff) ? lp->diff : openRecord.lpPeakDiff;
+    openRecord.status = (uint8_t)((openRecord.status & (uint8_t)(~REPORT_STATUS_STATE_MSK)) | sensorStatus |
+                                  (((uint32_t)appState << REPORT_STATUS_STATE_POS) & REPORT_STATUS_STATE_MSK));
+
+    if (REPORT_FRAMES_PER_RECORD <= openRecord.frameNum)
+    {
+        WriteReportRecord();
+    }
+
+    uptimeUs += framePeriod;
+    uptimeMs += uptimeUs / REPORT_US_PER_MS;
+    uptimeUs %= REPORT_US_PER_MS;
+}
+
+/*******************************************************************************
+* Function Name: WriteReportRecord
+********************************************************************************
+* Summary:
+* Writes the open record to the FIFO, starts a new one and drives the host
+* notify pin high for an event record or when REPORT_NOTIFY_RECORDS records
+* are not read yet.
+*
+*******************************************************************************/
+static void WriteReportRecord(void)
+{
+    reportData->record[reportData->recordCount & (REPORT_RECORD_NUM - 1u)] = openRecord;
+    reportData->recordCount++;
+
+#if ENABLE_REPORT_NOTIFY
+    unreadRecordCount++;
+
+    if ((0u != (openRecord.status & REPORT_STATUS_EVENT)) || (REPORT_NOTIFY_RECORDS <= unreadRecordCount))
+    {
+        Cy_GPIO_Set(CYBSP_HOST_NOTIFY_PORT, CYBSP_HOST_NOTIFY_NUM);
+    }
+#endif
+
+    memset(&openRecord, 0, sizeof(openRecord));
+}
+
+#endif /* ENABLE_BATCHED_REPORT */
+
+/* [] END OF FILE */
@@ -0,0 +1,137 @@
+/******************************************************************************
+* File Name: user_report.h
+*
+* Description: This file contains the macros, data types and function
+*              prototypes of the batched host reporting.
+*
+*******************************************************************************
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_USER_REPORT_H_
+#define SOURCE_USER_REPORT_H_
+
+#include "cy_pdl.h"
+#include "cybsp.h"
+
+/*******************************************************************************
+* User configurable Macros
+*******************************************************************************/
+/* Enable this, to aggregate the proximity, touch and low power widget status
+* and the peak diff counts of up to REPORT_FRAMES_PER_RECORD frames into one
+* record of a FIFO read by the host on the EZI2C secondary slave address. A
+* status change starts a new record, so the host sees every event even when
+* it polls at a few Hz */
+#ifndef ENABLE_BATCHED_REPORT
+#define ENABLE_BATCHED_REPORT       (0u)
+#endif
+
+/* Number of records of the FIFO, 12 bytes each */
+#define REPORT_RECORD_NUM           (32u)
+
+/* Frames aggregated in a record, about 125 ms in ACTIVE mode */
+#define REPORT_FRAMES_PER_RECORD    (16u)
+
+/* Enable this, to drive a pin named HOST_NOTIFY in the Device Configurator
+* high when a record with a status change or REPORT_NOTIFY_RECORDS records are
+* written since the last host read of the secondary slave address */
+#ifndef ENABLE_REPORT_NOTIFY
+#define ENABLE_REPORT_NOTIFY        (0u)
+#endif
+#define REPORT_NOTIFY_RECORDS       (REPORT_RECORD_NUM / 2u)
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Layout version of reportData_t, incremented on every layout change */
+#define REPORT_DATA_VERSION         (1u)
+
+/* Record status: the OR of the sensor status of the aggregated frames, the
+* application state of the last frame, and REPORT_STATUS_EVENT when the first
+* frame changed the sensor status */
+#define REPORT_STATUS_PROX          (0x01u) /* Proximity detected */
+#define REPORT_STATUS_TOUCH         (0x02u) /* Touch detected */
+#define REPORT_STATUS_LP            (0x04u) /* Low power widget active */
+#define REPORT_STATUS_SENSOR_MSK    (0x07u)
+#define REPORT_STATUS_STATE_POS     (4u)
+#define REPORT_STATUS_STATE_MSK     (0x70u)
+#define REPORT_STATUS_EVENT         (0x80u)
+
+#if (0u != (REPORT_RECORD_NUM & (REPORT_RECORD_NUM - 1u)))
+    #error "REPORT_RECORD_NUM must be a power of two"
+#endif
+
+#if (ENABLE_REPORT_NOTIFY && !ENABLE_BATCHED_REPORT)
+    #error "ENABLE_REPORT_NOTIFY needs ENABLE_BATCHED_REPORT"
+#endif
+
+#if (ENABLE_REPORT_NOTIFY && !defined(CYBSP_HOST_NOTIFY_PORT))
+    #error "ENABLE_REPORT_NOTIFY needs a pin named HOST_NOTIFY in the Device Configurator"
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+typedef struct reportRecord
+{
+    uint32_t timestamp;         /* First frame, ms since boot, from the refresh rate periods */
+    uint16_t proxPeakDiff;      /* Largest proximity sensor diff count */
+    uint16_t lpPeakDiff;        /* Largest low power sensor diff count */
+    uint8_t frameNum;           /* Frames aggregated */
+    uint8_t status;             /* REPORT_STATUS_* */
+    uint16_t reserved;
+} reportRecord_t;
+
+/* Record FIFO, exposed in the host interface on the EZI2C secondary slave
+* address. recordCount is incremented after each record is written, the record
+* written next is record[recordCount % REPORT_RECORD_NUM]. The host keeps the
+* recordCount of its last read, reads the new records and reads recordCount
+* again to drop the records that were overwritten meanwhile */
+typedef struct reportData
+{
+    uint8_t version;            /* REPORT_DATA_VERSION */
+    uint8_t recordSize;         /* sizeof(reportRecord_t) */
+    uint16_t recordNum;         /* REPORT_RECORD_NUM */
+    uint16_t recordCount;       /* Records written, wraps */
+    uint16_t framesPerRecord;   /* REPORT_FRAMES_PER_RECORD */
+    reportRecord_t record[REPORT_RECORD_NUM];
+} reportData_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void InitReport(reportData_t *);
+void ReportFrame(uint8_t appState, uint32_t framePeriod, bool hostRead);
+
+#endif /* SOURCE_USER_REPORT_H_ */
+
+/* [] END OF FILE */
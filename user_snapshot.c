@@ -0,0 +1,345 @@
+/*******************************************************************************
+ * File Name:   user_snapshot.c
+ *
+ * Description: This file contains the baseline snapshot. It saves the
+ *              baselines and the calibration results to a flash row and
+ *              restores the baselines at boot.
+ *
+ *******************************************************************************
+ *******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+ ******************************************************************************/
+
+
+#include "cycfg_capsense.h"
+#include "user_snapshot.h"
+
+#if ENABLE_BASELINE_SNAPSHOT
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define SNAPSHOT_CRC_INIT           (0xFFFFu)
+#define SNAPSHOT_CRC_POLYNOMIAL     (0x1021u)
+#define SNAPSHOT_CRC_MSB            (0x8000u)
+
+/* Bytes covered by the CRC, all except the crc member */
+#define SNAPSHOT_CRC_SIZE           (SNAPSHOT_SIZE - sizeof(uint16_t))
+
+#define SNAPSHOT_ROW_WORDS          (CY_FLASH_SIZEOF_ROW / sizeof(uint32_t))
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void CaptureSnapshot(baselineSnapshot_t * snapshot);
+static uint16_t GetSnapshotCrc(const baselineSnapshot_t * snapshot);
+static bool IsCalibrationEqual(const baselineSnapshot_t * a, const baselineSnapshot_t * b);
+static bool IsBaselineMoved(const baselineSnapshot_t * a, const baselineSnapshot_t * b);
+static uint32_t GetBaselineTolerance(void);
+
+/*******************************************************************************
+* Global Definitions
+*******************************************************************************/
+/* Flash row of the snapshot, cleared when the device is programmed. Read as
+* volatile, as it is changed by the flash writes */
+CY_SECTION(".cy_em_eeprom") CY_ALIGN(CY_FLASH_SIZEOF_ROW)
+static const volatile uint32_t snapshotRow[SNAPSHOT_ROW_WORDS] = {0u};
+
+/* Row written to the flash, the bytes after the snapshot stay zero */
+static union
+{
+    baselineSnapshot_t snapshot;
+    uint32_t row[SNAPSHOT_ROW_WORDS];
+} snapshotBuffer;
+
+/* Copy of the snapshot in the flash row, valid when storedSnapshotValid */
+static baselineSnapshot_t storedSnapshot;
+static bool storedSnapshotValid = false;
+
+/* Idle baseline refresh bursts since the last save */
+static uint32_t saveIntervalCount = 0u;
+
+/* Baseline movement saved again, below the lowest widget noise threshold */
+static uint32_t baselineTolerance = 0u;
+
+/*******************************************************************************
+* Function Name: RestoreBaselineSnapshot
+********************************************************************************
+* Summary:
+* Reads the snapshot from the flash row and restores the baselines of all the
+* sensors, when the version and the CRC are valid and the calibration done by
+* Cy_CapSense_Enable() gives the same CDAC codes and sense clocks as stored.
+* Called once after the CAPSENSE initialization, also to read the baseline
+* tolerance from the widget noise thresholds.
+*
+* Return:
+* true if the baselines are restored
+*
+*******************************************************************************/
+bool RestoreBaselineSnapshot(void)
+{
+    baselineSnapshot_t current;
+    uint32_t i;
+
+    for (i = 0u; i < (SNAPSHOT_SIZE / sizeof(uint32_t)); i++)
+    {
+        snapshotBuffer.row[i] = snapshotRow[i];
+    }
+
+    baselineTolerance = GetBaselineTolerance();
+
+    storedSnapshot = snapshotBuffer.snapshot;
+    storedSnapshotValid = (SNAPSHOT_VERSION == storedSnapshot.version) &&
+                          (GetSnapshotCrc(&storedSnapshot) == storedSnapshot.crc);
+
+    CaptureSnapshot(&current);
+
+    if (!storedSnapshotValid || !IsCalibrationEqual(&storedSnapshot, &current))
+    {
+        /* Saved again after the first idle baseline refresh burst */
+        storedSnapshotValid = false;
+        return false;
+    }
+
+    for (i = 0u; i < CY_CAPSENSE_SENSOR_COUNT; i++)
+    {
+        cy_capsense_tuner.sensorContext[i].bsln = storedSnapshot.sensor[i].bsln;
+        cy_capsense_tuner.sensorContext[i].bslnExt = 0u;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: UpdateBaselineSnapshot
+********************************************************************************
+* Summary:
+* Saves the baselines and the calibration results to the flash row when there
+* is no valid snapshot, the calibration changed, a baseline moved by more than
+* the tolerance after SNAPSHOT_SAVE_INTERVAL calls, or after SNAPSHOT_AGE_MAX
+* calls. Called after an idle baseline refresh burst, when no scan is in
+* progress.
+*
+*******************************************************************************/
+void UpdateBaselineSnapshot(void)
+{
+    baselineSnapshot_t * snapshot = &snapshotBuffer.snapshot;
+
+    if (saveIntervalCount < SNAPSHOT_AGE_MAX)
+    {
+        saveIntervalCount++;
+    }
+
+    CaptureSnapshot(snapshot);
+
+    if (storedSnapshotValid && IsCalibrationEqual(&storedSnapshot, snapshot) &&
+        (saveIntervalCount < SNAPSHOT_AGE_MAX) &&
+        ((saveIntervalCount < SNAPSHOT_SAVE_INTERVAL) || !IsBaselineMoved(&storedSnapshot, snapshot)))
+    {
+        return;
+    }
+
+    saveIntervalCount = 0u;
+
+    /* A failed write is retried after the next idle baseline refresh burst */
+    storedSnapshotValid = (CY_FLASH_DRV_SUCCESS ==
+                           Cy_Flash_WriteRow((uint32_t)&snapshotRow[0u], snapshotBuffer.row));
+    storedSnapshot = *snapshot;
+}
+
+/*******************************************************************************
+* Function Name: CaptureSnapshot
+********************************************************************************
+* Summary:
+* Fills the snapshot from the current CAPSENSE widget and sensor contexts.
+*
+* Parameters:
+* snapshot - pointer to the snapshot
+*
+*******************************************************************************/
+static void CaptureSnapshot(baselineSnapshot_t * snapshot)
+{
+    uint32_t i;
+
+    snapshot->version = SNAPSHOT_VERSION;
+    snapshot->configId = cy_capsense_context.ptrCommonContext->configId;
+
+    for (i = 0u; i < CY_CAPSENSE_WIDGET_COUNT; i++)
+    {
+        snapshot->widget[i].snsClk = cy_capsense_tuner.widgetContext[i].snsClk;
+        snapshot->widget[i].cdacRef = cy_capsense_tuner.widgetContext[i].cdacRef;
+        snapshot->widget[i].reserved = 0u;
+    }
+
+    for (i = 0u; i < CY_CAPSENSE_SENSOR_COUNT; i++)
+    {
+        snapshot->sensor[i].bsln = cy_capsense_tuner.sensorContext[i].bsln;
+        snapshot->sensor[i].cdacComp = cy_capsense_tuner.sensorContext[i].cdacComp;
+        snapshot->sensor[i].reserved = 0u;
+    }
+
+    snapshot->reserved = 0u;
+    snapshot->crc = GetSnapshotCrc(snapshot);
+}
+
+/*******************************************************************************
+* Function Name: GetSnapshotCrc
+********************************************************************************
+* Summary:
+* Calculates the CRC-16/CCITT of the snapshot, without the crc member.
+*
+* Parameters:
+* snapshot - pointer to the snapshot
+*
+* Return:
+* CRC of the snapshot
+*
+*******************************************************************************/
+static uint16_t GetSnapshotCrc(const baselineSnapshot_t * snapshot)
+{
+    const uint8_t * data = (const uint8_t *)snapshot;
+    uint32_t crc = SNAPSHOT_CRC_INIT;
+    uint32_t i;
+    uint32_t bit;
+
+    for (i = 0u; i < SNAPSHOT_CRC_SIZE; i++)
+    {
+        crc ^= (uint32_t)data[i] << 8u;
+
+        for (bit = 0u; bit < 8u; bit++)
+        {
+            crc = (0u != (crc & SNAPSHOT_CRC_MSB)) ? ((crc << 1u) ^ SNAPSHOT_CRC_POLYNOMIAL) : (crc << 1u);
+        }
+    }
+
+    return (uint16_t)crc;
+}
+
+/*******************************************************************************
+* Function Name: IsCalibrationEqual
+********************************************************************************
+* Summary:
+* Compares the CAPSENSE configuration and the calibration results of two
+* snapshots.
+*
+* Return:
+* true if the configuration ID, the sense clocks and the CDAC codes are equal
+*
+*******************************************************************************/
+static bool IsCalibrationEqual(const baselineSnapshot_t * a, const baselineSnapshot_t * b)
+{
+    uint32_t i;
+
+    if (a->configId != b->configId)
+    {
+        return false;
+    }
+
+    for (i = 0u; i < CY_CAPSENSE_WIDGET_COUNT; i++)
+    {
+        if ((a->widget[i].snsClk != b->widget[i].snsClk) ||
+            (a->widget[i].cdacRef != b->widget[i].cdacRef))
+        {
+            return false;
+        }
+    }
+
+    for (i = 0u; i < CY_CAPSENSE_SENSOR_COUNT; i++)
+    {
+        if (a->sensor[i].cdacComp != b->sensor[i].cdacComp)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: IsBaselineMoved
+********************************************************************************
+* Summary:
+* Checks whether any baseline differs between two snapshots by more than the
+* baseline tolerance.
+*
+* Return:
+* true if a baseline moved
+*
+*******************************************************************************/
+static bool IsBaselineMoved(const baselineSnapshot_t * a, const baselineSnapshot_t * b)
+{
+    uint32_t i;
+    int32_t delta;
+
+    for (i = 0u; i < CY_CAPSENSE_SENSOR_COUNT; i++)
+    {
+        delta = (int32_t)a->sensor[i].bsln - (int32_t)b->sensor[i].bsln;
+
+        if ((delta > (int32_t)baselineTolerance) || (delta < -(int32_t)baselineTolerance))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+* Function Name: GetBaselineTolerance
+********************************************************************************
+* Summary:
+* Gets the baseline tolerance from the lowest noise threshold of the widgets,
+* shifted right by SNAPSHOT_TOLERANCE_SHIFT.
+*
+* Return:
+* baseline tolerance in counts
+*
+*******************************************************************************/
+static uint32_t GetBaselineTolerance(void)
+{
+    uint32_t noiseTh = UINT16_MAX;
+    uint32_t i;
+
+    for (i = 0u; i < CY_CAPSENSE_WIDGET_COUNT; i++)
+    {
+        if (cy_capsense_tuner.widgetContext[i].noiseTh < noiseTh)
+        {
+            noiseTh = cy_capsense_tuner.widgetContext[i].noiseTh;
+        }
+    }
+
+    return noiseTh >> SNAPSHOT_TOLERANCE_SHIFT;
+}
+
+#endif /* ENABLE_BASELINE_SNAPSHOT */
+
+/* [] END OF FILE */
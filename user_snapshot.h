@@ -0,0 +1,122 @@
+/******************************************************************************
+* File Name: user_snapshot.h
+*
+* Description: This file contains the macros, data types and function
+*              prototypes of the baseline snapshot kept in flash.
+*
+*******************************************************************************
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_USER_SNAPSHOT_H_
+#define SOURCE_USER_SNAPSHOT_H_
+
+#include "cy_pdl.h"
+#include "cycfg_capsense.h"
+
+/*******************************************************************************
+* User configurable Macros
+*******************************************************************************/
+/* Enable this, to keep the baselines and the calibration results of the idle
+* baseline refresh bursts in a flash row, and to restore the baselines at boot
+* when the calibration matches the stored one. The baselines are then valid
+* from the first frame, also when the sensor is touched at boot. A restored
+* baseline is as old as the last save, so this is disabled by default. The
+* snapshot is saved in BASELINE_MODE, which needs ENABLE_WOT_DIRECT_REARM */
+#ifndef ENABLE_BASELINE_SNAPSHOT
+#define ENABLE_BASELINE_SNAPSHOT    (0u)
+#endif
+
+/* The snapshot is saved again after SNAPSHOT_SAVE_INTERVAL idle baseline
+* refresh bursts, about one hour with the default WOT settings, when a
+* baseline moved by more than the tolerance since the last save. The tolerance
+* is the lowest widget noise threshold shifted right by
+* SNAPSHOT_TOLERANCE_SHIFT, so a restored baseline stays within the noise. The
+* snapshot is saved anyway after SNAPSHOT_AGE_MAX idle baseline refresh bursts,
+* about one day, which bounds its age at the power loss. This limits the flash
+* wear to a few thousand row writes a year */
+#define SNAPSHOT_SAVE_INTERVAL      (60u)
+#define SNAPSHOT_TOLERANCE_SHIFT    (1u)
+#define SNAPSHOT_AGE_MAX            (24u * SNAPSHOT_SAVE_INTERVAL)
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Layout version of baselineSnapshot_t, incremented on every layout change */
+#define SNAPSHOT_VERSION            (1u)
+
+/* Size of baselineSnapshot_t, must fit in a flash row */
+#define SNAPSHOT_SIZE               (4u + (4u * CY_CAPSENSE_WIDGET_COUNT) + \
+                                     (4u * CY_CAPSENSE_SENSOR_COUNT) + 4u)
+
+#if (SNAPSHOT_SIZE > CY_FLASH_SIZEOF_ROW)
+    #error "The baseline snapshot does not fit in a flash row"
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+typedef struct snapshotWidget
+{
+    uint16_t snsClk;            /* Sense clock divider */
+    uint8_t cdacRef;            /* Reference CDAC code */
+    uint8_t reserved;
+} snapshotWidget_t;
+
+typedef struct snapshotSensor
+{
+    uint16_t bsln;              /* Baseline */
+    uint8_t cdacComp;           /* Compensation CDAC code */
+    uint8_t reserved;
+} snapshotSensor_t;
+
+/* Snapshot stored at the start of the flash row. crc is the CRC-16/CCITT of
+* all the preceding bytes */
+typedef struct baselineSnapshot
+{
+    uint16_t version;           /* SNAPSHOT_VERSION */
+    uint16_t configId;          /* CAPSENSE configuration ID */
+    snapshotWidget_t widget[CY_CAPSENSE_WIDGET_COUNT];
+    snapshotSensor_t sensor[CY_CAPSENSE_SENSOR_COUNT];
+    uint16_t reserved;
+    uint16_t crc;
+} baselineSnapshot_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool RestoreBaselineSnapshot(void);
+void UpdateBaselineSnapshot(void);
+
+#endif /* SOURCE_USER_SNAPSHOT_H_ */
+
+/* [] END OF FILE */
@@ -43,17 +43,157 @@
  ******************************************************************************/
 cy_stc_scb_spi_context_t UserSpiContext;
 
+/* Set from the SPI interrupt when the last started packet is transmitted */
+static volatile bool spiTransferDone = true;
+
+static spiDoneCallback_t spiDoneCallback = NULL;
+
+/* Producer of the streamed transfer in progress, NULL - no streamed transfer */
+static spiStreamFill_t spiStreamFill = NULL;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static void SpiEventCallback(uint32_t event);
+static void SpiStreamInterrupt(void);
+static void RefillSpiStream(void);
+static void FinishSpiTransfer(void);
+
 
 /*******************************************************************************
  * Function Name: UserSpiInterrupt
  *******************************************************************************
  *
- * Invokes the Cy_SCB_SPI_Interrupt() PDL driver function.
+ * Invokes the Cy_SCB_SPI_Interrupt() PDL driver function, or refills the Tx
+ * FIFO while a streamed transfer is in progress.
  *
  ******************************************************************************/
 void UserSpiInterrupt(void)
 {
-    Cy_SCB_SPI_Interrupt(CYBSP_MASTER_SPI_HW, &UserSpiContext);
+    if (NULL != spiStreamFill)
+    {
+        SpiStreamInterrupt();
+    }
+    else
+    {
+        Cy_SCB_SPI_Interrupt(CYBSP_MASTER_SPI_HW, &UserSpiContext);
+    }
+}
+
+
+/*******************************************************************************
+ * Function Name: SpiStreamInterrupt
+ *******************************************************************************
+ *
+ * Summary:
+ * SPI interrupt handler of a streamed transfer. Refills the Tx FIFO when it
+ * drains below SPI_STREAM_FIFO_LEVEL and completes the transfer when the last
+ * byte is shifted out.
+ *
+ ******************************************************************************/
+static void SpiStreamInterrupt(void)
+{
+    if (0UL != (Cy_SCB_SPI_GetTxInterruptStatusMasked(CYBSP_MASTER_SPI_HW) & CY_SCB_SPI_TX_TRIGGER))
+    {
+        RefillSpiStream();
+    }
+
+    if (0UL != (Cy_SCB_SPI_GetMasterInterruptStatusMasked(CYBSP_MASTER_SPI_HW) & CY_SCB_SPI_MASTER_DONE))
+    {
+        Cy_SCB_SPI_ClearMasterInterrupt(CYBSP_MASTER_SPI_HW, CY_SCB_SPI_MASTER_DONE);
+
+        /* The done event is also set by a Tx FIFO underrun in the middle of
+        * the stream, the transfer is complete only when the FIFO is empty */
+        if (Cy_SCB_SPI_IsTxComplete(CYBSP_MASTER_SPI_HW))
+        {
+            Cy_SCB_SPI_SetMasterInterruptMask(CYBSP_MASTER_SPI_HW, CY_SCB_SPI_INTR_NONE);
+            Cy_SCB_SPI_ClearRxFifo(CYBSP_MASTER_SPI_HW);
+
+            spiStreamFill = NULL;
+            FinishSpiTransfer();
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * Function Name: RefillSpiStream
+ *******************************************************************************
+ *
+ * Summary:
+ * Fills the free space of the Tx FIFO with the next bytes of the streamed
+ * transfer and enables the Tx FIFO level interrupt. When the producer has no
+ * more data, the Tx FIFO level interrupt is replaced by the master done
+ * interrupt.
+ *
+ ******************************************************************************/
+static void RefillSpiStream(void)
+{
+    uint8_t txData[SPI_STREAM_FIFO_DEPTH];
+    uint32_t size;
+
+    size = spiStreamFill(txData, SPI_STREAM_FIFO_DEPTH - Cy_SCB_SPI_GetNumInTxFifo(CYBSP_MASTER_SPI_HW));
+
+    if (0UL != size)
+    {
+        (void)Cy_SCB_SPI_WriteArray(CYBSP_MASTER_SPI_HW, txData, size);
+        Cy_SCB_SPI_SetTxInterruptMask(CYBSP_MASTER_SPI_HW, CY_SCB_SPI_TX_TRIGGER);
+    }
+    else
+    {
+        Cy_SCB_SPI_SetTxInterruptMask(CYBSP_MASTER_SPI_HW, CY_SCB_SPI_INTR_NONE);
+        Cy_SCB_SPI_SetMasterInterruptMask(CYBSP_MASTER_SPI_HW, CY_SCB_SPI_MASTER_DONE);
+    }
+
+    Cy_SCB_SPI_ClearTxInterrupt(CYBSP_MASTER_SPI_HW, CY_SCB_SPI_TX_TRIGGER);
+}
+
+
+/*******************************************************************************
+ * Function Name: FinishSpiTransfer
+ *******************************************************************************
+ *
+ * Summary:
+ * Marks the transfer in progress as done and notifies the registered callback.
+ * Called from the SPI interrupt.
+ *
+ ******************************************************************************/
+static void FinishSpiTransfer(void)
+{
+    spiTransferDone = true;
+
+    MARKER_TOGGLE(LED_SENT);
+    PROFILER_STOP(PROFILER_STAGE_SEND_SPI_PACKET);
+    ENERGY_COMM_STOP(ENERGY_COMM_SPI);
+
+    if (NULL != spiDoneCallback)
+    {
+        spiDoneCallback();
+    }
+}
+
+
+/*******************************************************************************
+ * Function Name: SpiEventCallback
+ *******************************************************************************
+ *
+ * Summary:
+ * SPI driver event callback, called from UserSpiInterrupt(). Marks the packet
+ * transfer as done, clears the Tx FIFO and notifies the registered callback.
+ *
+ * Parameters:
+ * event - SPI driver event, see Cy_SCB_SPI_RegisterCallback()
+ *
+ ******************************************************************************/
+static void SpiEventCallback(uint32_t event)
+{
+    if (0UL != (event & (CY_SCB_SPI_TRANSFER_CMPLT_EVENT | CY_SCB_SPI_TRANSFER_ERR_EVENT)))
+    {
+        /* Clear SPI transmission buffer */
+        Cy_SCB_SPI_ClearTxFifo(CYBSP_MASTER_SPI_HW);
+
+        FinishSpiTransfer();
+    }
 }
 
 
@@ -78,6 +218,13 @@ uint32_t InitSpiMaster(void)
     cy_en_scb_spi_status_t result;
     cy_en_sysint_status_t sysSpiStatus;
 
+    /* The serial LED encoding is built for this SCB clock and oversampling */
+    if ((SPI_OVERSAMPLE != CYBSP_MASTER_SPI_config.oversample) ||
+        (SPI_SCB_CLK_HZ != Cy_SysClk_PeriphGetFrequency(SPI_SCB_CLK_DIV_TYPE, SPI_SCB_CLK_DIV_NUM)))
+    {
+        return INIT_FAILURE;
+    }
+
     /* Configure the SPI block */
 
     result = Cy_SCB_SPI_Init(CYBSP_MASTER_SPI_HW, &CYBSP_MASTER_SPI_config, &UserSpiContext);
@@ -107,6 +254,9 @@ uint32_t InitSpiMaster(void)
     /* Enable interrupt in NVIC */
     NVIC_EnableIRQ(CYBSP_MASTER_SPI_IRQ);
 
+    /* Get notified from the SPI interrupt when a transfer completes */
+    Cy_SCB_SPI_RegisterCallback(CYBSP_MASTER_SPI_HW, &SpiEventCallback, &UserSpiContext);
+
     /* Enable the SPI Master block */
     Cy_SCB_SPI_Enable(CYBSP_MASTER_SPI_HW);
 
@@ -137,12 +287,10 @@ cy_en_scb_spi_status_t SendSpiPacket(uint8_t *txBuffer, uint32_t transferSize)
     cy_en_scb_spi_status_t masterStatus;
 
     /* Initiate SPI Master write transaction. */
-    masterStatus = Cy_SCB_SPI_Transfer(CYBSP_MASTER_SPI_HW, txBuffer, NULL,
-                                        transferSize, &UserSpiContext);
+    masterStatus = SendSpiPacketAsync(txBuffer, transferSize);
 
    /* Blocking wait for transfer completion */
-    while (0UL != (CY_SCB_SPI_TRANSFER_ACTIVE &
-                Cy_SCB_SPI_GetTransferStatus(CYBSP_MASTER_SPI_HW, &UserSpiContext)))
+    while (IsSpiTransferActive())
     {
 
     }
@@ -150,4 +298,125 @@ cy_en_scb_spi_status_t SendSpiPacket(uint8_t *txBuffer, uint32_t transferSize)
     return masterStatus;
 }
 
+
+/*******************************************************************************
+ * Function Name: SendSpiPacketAsync
+ *******************************************************************************
+ *
+ * Summary:
+ * This function starts sending the data to the SPI slave and returns without
+ * waiting. The SPI interrupt refills the Tx FIFO until the transfer is
+ * complete, then calls the callback registered by RegisterSpiDoneCallback().
+ * txBuffer must not be modified while IsSpiTransferActive() returns true.
+ *
+ * Parameters:
+ * txBuffer - Pointer to the transmit buffer
+ * transferSize - Number of bytes to be transmitted
+ *
+ * Return:
+ * cy_en_scb_spi_status_t - CY_SCB_SPI_SUCCESS if the transaction is started
+ * successfully. Otherwise it returns the error status
+ *
+ ******************************************************************************/
+cy_en_scb_spi_status_t SendSpiPacketAsync(uint8_t *txBuffer, uint32_t transferSize)
+{
+    cy_en_scb_spi_status_t masterStatus;
+
+    spiTransferDone = false;
+
+    PROFILER_START(PROFILER_STAGE_SEND_SPI_PACKET);
+    ENERGY_COMM_START(ENERGY_COMM_SPI);
+
+    /* Initiate SPI Master write transaction. */
+    masterStatus = Cy_SCB_SPI_Transfer(CYBSP_MASTER_SPI_HW, txBuffer, NULL,
+                                        transferSize, &UserSpiContext);
+
+    if (CY_SCB_SPI_SUCCESS != masterStatus)
+    {
+        spiTransferDone = true;
+        ENERGY_COMM_STOP(ENERGY_COMM_SPI);
+    }
+
+    return masterStatus;
+}
+
+
+/*******************************************************************************
+ * Function Name: SendSpiStreamAsync
+ *******************************************************************************
+ *
+ * Summary:
+ * Starts a transfer whose data is produced on demand instead of being taken
+ * from a buffer. The first bytes are produced and written into the Tx FIFO
+ * right away, then the SPI interrupt calls fill each time the Tx FIFO drains
+ * below SPI_STREAM_FIFO_LEVEL until it returns 0. Completion is reported as
+ * for SendSpiPacketAsync(). fill must produce at least one byte on its first
+ * call.
+ *
+ * Parameters:
+ * fill - producer of the transfer data, called from the SPI interrupt
+ *
+ * Return:
+ * cy_en_scb_spi_status_t - CY_SCB_SPI_SUCCESS if the transfer is started,
+ * CY_SCB_SPI_TRANSFER_BUSY if a transfer is already in progress
+ *
+ ******************************************************************************/
+cy_en_scb_spi_status_t SendSpiStreamAsync(spiStreamFill_t fill)
+{
+    if (IsSpiTransferActive())
+    {
+        return CY_SCB_SPI_TRANSFER_BUSY;
+    }
+
+    spiTransferDone = false;
+    spiStreamFill = fill;
+
+    PROFILER_START(PROFILER_STAGE_SEND_SPI_PACKET);
+    ENERGY_COMM_START(ENERGY_COMM_SPI);
+
+    Cy_SCB_SPI_SetTxFifoLevel(CYBSP_MASTER_SPI_HW, SPI_STREAM_FIFO_LEVEL);
+    Cy_SCB_SPI_ClearMasterInterrupt(CYBSP_MASTER_SPI_HW, CY_SCB_SPI_MASTER_DONE);
+
+    /* Unmasks the SPI interrupt once the first bytes are in the Tx FIFO */
+    RefillSpiStream();
+
+    return CY_SCB_SPI_SUCCESS;
+}
+
+
+/*******************************************************************************
+ * Function Name: IsSpiTransferActive
+ *******************************************************************************
+ *
+ * Summary:
+ * Checks whether a packet started by SendSpiPacketAsync() is still being
+ * transmitted.
+ *
+ * Return:
+ * bool - true while the transfer is in progress
+ *
+ ******************************************************************************/
+bool IsSpiTransferActive(void)
+{
+    return (!spiTransferDone);
+}
+
+
+/*******************************************************************************
+ * Function Name: RegisterSpiDoneCallback
+ *******************************************************************************
+ *
+ * Summary:
+ * Registers a function to be called from the SPI interrupt on completion of
+ * each packet transfer. Pass NULL to remove the callback.
+ *
+ * Parameters:
+ * callback - Pointer to the callback function
+ *
+ ******************************************************************************/
+void RegisterSpiDoneCallback(spiDoneCallback_t callback)
+{
+    spiDoneCallback = callback;
+}
+
 /* [] END OF FILE */
@@ -41,6 +41,9 @@
 
 #include "cy_pdl.h"
 #include "cycfg.h"
+#include "user_profiler.h"
+#include "user_energy.h"
+#include "user_marker.h"
 
 /*******************************************************************************
  * Macros
@@ -61,11 +64,48 @@
 /* Assign SPI interrupt priority */
 #define CYBSP_MASTER_SPI_INTR_PRIORITY  (0U)
 
+/* Clock frequency of the SPI SCB in Hz and its oversampling, as in design.modus:
+* the peri_0_div_16_0 divider of 3 from the 48 MHz HFCLK and an oversample of 5.
+* The SPI data rate is their ratio, 3.2 Mbps. InitSpiMaster() fails when the
+* generated configuration differs */
+#ifndef SPI_SCB_CLK_HZ
+#define SPI_SCB_CLK_HZ                  (16000000U)
+#endif
+#ifndef SPI_OVERSAMPLE
+#define SPI_OVERSAMPLE                  (5U)
+#endif
+#define SPI_SCB_CLK_DIV_TYPE            (peri_0_div_16_0_HW)
+#define SPI_SCB_CLK_DIV_NUM             (peri_0_div_16_0_NUM)
+
+/* SPI data rate in bits per second */
+#define SPI_BIT_RATE                    (SPI_SCB_CLK_HZ / SPI_OVERSAMPLE)
+
+/* Tx FIFO depth of the SPI SCB in bytes and the number of bytes in the Tx FIFO
+* below which the streamed transfer refills it. At 3.2 Mbps the remaining
+* bytes leave ~10 us of interrupt latency before the transmission stalls */
+#define SPI_STREAM_FIFO_DEPTH           (8U)
+#define SPI_STREAM_FIFO_LEVEL           (4U)
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* Function called from the SPI interrupt when a packet transfer completes */
+typedef void (*spiDoneCallback_t)(void);
+
+/* Function called to produce the next bytes of a streamed transfer. Writes up
+* to size bytes into txData and returns the number written, 0 when all the
+* data is produced */
+typedef uint32_t (*spiStreamFill_t)(uint8_t *txData, uint32_t size);
+
 /***************************************
 *         Function Prototypes
 ****************************************/
 uint32_t InitSpiMaster(void);
 cy_en_scb_spi_status_t SendSpiPacket(uint8_t *, uint32_t);
+cy_en_scb_spi_status_t SendSpiPacketAsync(uint8_t *, uint32_t);
+cy_en_scb_spi_status_t SendSpiStreamAsync(spiStreamFill_t);
+bool IsSpiTransferActive(void);
+void RegisterSpiDoneCallback(spiDoneCallback_t);
 
 #endif /* SOURCE_USER_SPI_H_ */
 
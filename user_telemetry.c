@@ -0,0 +1,194 @@
+/*******************************************************************************
+ * File Name:   user_telemetry.c
+ *
+ * Description: This file contains the host interface exposed on the EZI2C
+ *              secondary slave address: compact per-frame telemetry followed
+ *              by the optional diagnostic data blocks.
+ *
+ *******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+ ******************************************************************************/
+
+#include <string.h>
+#include "cycfg_capsense.h"
+#include "user_telemetry.h"
+
+#if ENABLE_TELEMETRY
+
+/*******************************************************************************
+* Global Definitions
+*******************************************************************************/
+hostInterface_t hostInterface;
+
+/*******************************************************************************
+* Function Name: InitTelemetry
+********************************************************************************
+* Summary:
+* Clears the host interface and initializes the diagnostic data blocks.
+*
+*******************************************************************************/
+void InitTelemetry(void)
+{
+    memset(&hostInterface, 0, sizeof(hostInterface));
+
+    hostInterface.telemetry.version = TELEMETRY_VERSION;
+    hostInterface.telemetry.features = (uint8_t)TELEMETRY_FEATURES;
+    hostInterface.telemetry.size = (uint16_t)sizeof(hostInterface);
+
+    /* Not measured until SetTelemetryTiming() is called */
+    hostInterface.telemetry.scanTime = TELEMETRY_TIME_MAX;
+    hostInterface.telemetry.processTime = TELEMETRY_TIME_MAX;
+
+#if ENABLE_PROFILER
+    InitProfiler(&hostInterface.profiler);
+#endif
+
+#if ENABLE_ENERGY_ACCOUNTING
+    InitEnergy(&hostInterface.energy);
+#endif
+
+#if ENABLE_TRACE_CAPTURE
+    InitTrace(&hostInterface.trace);
+#endif
+
+#if ENABLE_BATCHED_REPORT
+    InitReport(&hostInterface.report);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: UpdateTelemetry
+********************************************************************************
+* Summary:
+* Updates the telemetry with the status of the current frame. Called once per
+* frame. The update is done in a critical section, so the EZI2C interrupt never
+* returns a partially updated telemetry to the host. With ENABLE_TRACE_CAPTURE
+* the frame is also captured in the trace.
+*
+* Parameters:
+* appState - current application state
+*
+*******************************************************************************/
+void UpdateTelemetry(uint8_t appState)
+{
+    telemetryData_t * telemetry = &hostInterface.telemetry;
+    uint32_t interruptStatus;
+    uint8_t proxStatus;
+    uint8_t lpStatus;
+
+    proxStatus = (uint8_t)Cy_CapSense_IsProximitySensorActive(CY_CAPSENSE_PROXIMITY0_WDGT_ID,
+                                                              CY_CAPSENSE_PROXIMITY0_SNS0_ID,
+                                                              &cy_capsense_context);
+    lpStatus = (uint8_t)Cy_CapSense_IsWidgetActive(CY_CAPSENSE_LOWPOWER0_WDGT_ID, &cy_capsense_context);
+
+    interruptStatus = Cy_SysLib_EnterCriticalSection();
+
+    telemetry->appState = appState;
+    telemetry->proxStatus = proxStatus;
+    telemetry->lpStatus = lpStatus;
+    telemetry->proxDiff = cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].diff;
+    telemetry->proxBsln = cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID].bsln;
+    telemetry->frameCount++;
+
+    Cy_SysLib_ExitCriticalSection(interruptStatus);
+
+#if ENABLE_TRACE_CAPTURE
+    CaptureTrace(appState);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: SetTelemetryTiming
+********************************************************************************
+* Summary:
+* Updates the measured scan and process time in the telemetry.
+*
+* Parameters:
+* scanTime - scan time in us
+* processTime - process time in us
+*
+*******************************************************************************/
+void SetTelemetryTiming(uint32_t scanTime, uint32_t processTime)
+{
+    hostInterface.telemetry.scanTime = (uint16_t)((scanTime < TELEMETRY_TIME_MAX) ?
+                                                  scanTime : TELEMETRY_TIME_MAX);
+    hostInterface.telemetry.processTime = (uint16_t)((processTime < TELEMETRY_TIME_MAX) ?
+                                                     processTime : TELEMETRY_TIME_MAX);
+}
+
+/*******************************************************************************
+* Function Name: SetTelemetryOverrun
+********************************************************************************
+* Summary:
+* Updates the frame overrun counters in the host interface.
+*
+* Parameters:
+* overrunCount - frames overrun
+* maxLateness - worst lateness in us
+*
+*******************************************************************************/
+void SetTelemetryOverrun(uint32_t overrunCount, uint32_t maxLateness)
+{
+    hostInterface.overrun.overrunCount = overrunCount;
+    hostInterface.overrun.maxLateness = maxLateness;
+}
+
+/*******************************************************************************
+* Function Name: CountTelemetryTransition
+********************************************************************************
+* Summary:
+* Counts the application state transition. The counters are 32-bit aligned, so
+* the host always reads a consistent value. The counters saturate.
+*
+* Parameters:
+* fromState - state left
+* toState - state entered
+*
+*******************************************************************************/
+void CountTelemetryTransition(uint8_t fromState, uint8_t toState)
+{
+    uint32_t * count;
+
+    if ((fromState < TELEMETRY_STATE_NUM) && (toState < TELEMETRY_STATE_NUM))
+    {
+        count = &hostInterface.transitions.transitionCount[fromState][toState];
+
+        if (UINT32_MAX != *count)
+        {
+            (*count)++;
+        }
+    }
+}
+
+#endif /* ENABLE_TELEMETRY */
+
+/* [] END OF FILE */
@@ -0,0 +1,167 @@
+/******************************************************************************
+* File Name: user_telemetry.h
+*
+* Description: This file contains the data types and function prototypes of
+*              the host interface exposed on the EZI2C secondary slave address.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_USER_TELEMETRY_H_
+#define SOURCE_USER_TELEMETRY_H_
+
+#include "cy_pdl.h"
+#include "user_profiler.h"
+#include "user_energy.h"
+#include "user_trace.h"
+#include "user_report.h"
+
+/*******************************************************************************
+* User configurable Macros
+*******************************************************************************/
+/* Enable this, to expose the host interface on the EZI2C secondary slave address */
+#ifndef ENABLE_TELEMETRY
+#define ENABLE_TELEMETRY            (1u)
+#endif
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Layout version of hostInterface_t, incremented on every layout change */
+#define TELEMETRY_VERSION           (8u)
+
+/* Bits of telemetryData_t features, set for the optional blocks present in
+* hostInterface_t after the overrun block, in this order */
+#define TELEMETRY_FEATURE_PROFILER  (0x01u)
+#define TELEMETRY_FEATURE_ENERGY    (0x02u)
+#define TELEMETRY_FEATURE_TRACE     (0x04u)
+#define TELEMETRY_FEATURE_REPORT    (0x08u)
+
+#define TELEMETRY_FEATURES          ((ENABLE_PROFILER ? TELEMETRY_FEATURE_PROFILER : 0u) | \
+                                     (ENABLE_ENERGY_ACCOUNTING ? TELEMETRY_FEATURE_ENERGY : 0u) | \
+                                     (ENABLE_TRACE_CAPTURE ? TELEMETRY_FEATURE_TRACE : 0u) | \
+                                     (ENABLE_BATCHED_REPORT ? TELEMETRY_FEATURE_REPORT : 0u))
+
+/* Number of states in the transition counters, covers the APPLICATION_STATE values */
+#define TELEMETRY_STATE_NUM         (5u)
+
+/* Scan and process time of a frame not measured, or 65535 us and above */
+#define TELEMETRY_TIME_MAX          (0xFFFFu)
+
+#if (ENABLE_PROFILER && !ENABLE_TELEMETRY)
+    #error "The profiler data is exposed through the host interface, enable ENABLE_TELEMETRY"
+#endif
+
+#if (ENABLE_ENERGY_ACCOUNTING && !ENABLE_TELEMETRY)
+    #error "The energy data is exposed through the host interface, enable ENABLE_TELEMETRY"
+#endif
+
+#if (ENABLE_TRACE_CAPTURE && !ENABLE_TELEMETRY)
+    #error "The trace is exposed through the host interface, enable ENABLE_TELEMETRY"
+#endif
+
+#if (ENABLE_BATCHED_REPORT && !ENABLE_TELEMETRY)
+    #error "The report is exposed through the host interface, enable ENABLE_TELEMETRY"
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+/* Per-frame status, 20 bytes. All fields are naturally aligned, so the
+* structure has no padding */
+typedef struct telemetryData
+{
+    uint8_t version;        /* TELEMETRY_VERSION */
+    uint8_t appState;       /* ACTIVE, ALR, WOT or baseline refresh mode */
+    uint8_t proxStatus;     /* Proximity sensor status: 0 - none, 1 - proximity, 3 - touch */
+    uint8_t lpStatus;       /* Low power widget active status */
+    uint16_t proxDiff;      /* Proximity sensor diff count */
+    uint16_t proxBsln;      /* Proximity sensor baseline */
+    uint32_t frameCount;    /* Incremented on every frame */
+    uint16_t scanTime;      /* Last measured scan time in us, measured by
+                            * ENABLE_TIMER_CALIBRATION, else TELEMETRY_TIME_MAX */
+    uint16_t processTime;   /* Last measured process time in us, as scanTime */
+    uint8_t features;       /* TELEMETRY_FEATURE_* bits of the blocks present */
+    uint8_t reserved;       /* Always 0 */
+    uint16_t size;          /* sizeof(hostInterface_t) */
+} telemetryData_t;
+
+/* Application state transition counters, transitionCount[from][to] */
+typedef struct transitionData
+{
+    uint32_t transitionCount[TELEMETRY_STATE_NUM][TELEMETRY_STATE_NUM];
+} transitionData_t;
+
+/* ACTIVE and ALR mode frames stretched beyond the refresh rate period */
+typedef struct overrunData
+{
+    uint32_t overrunCount;  /* Frames overrun, saturates */
+    uint32_t maxLateness;   /* Worst lateness in us */
+} overrunData_t;
+
+/* Data exposed read-only on the EZI2C secondary slave address. The compact
+* telemetry comes first, so polling hosts read only sizeof(telemetryData_t) */
+typedef struct hostInterface
+{
+    telemetryData_t telemetry;
+    transitionData_t transitions;
+    overrunData_t overrun;
+#if ENABLE_PROFILER
+    profilerData_t profiler;
+#endif
+#if ENABLE_ENERGY_ACCOUNTING
+    energyData_t energy;
+#endif
+#if ENABLE_TRACE_CAPTURE
+    traceData_t trace;
+#endif
+#if ENABLE_BATCHED_REPORT
+    reportData_t report;
+#endif
+} hostInterface_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+#if ENABLE_TELEMETRY
+extern hostInterface_t hostInterface;
+
+void InitTelemetry(void);
+void UpdateTelemetry(uint8_t appState);
+void SetTelemetryTiming(uint32_t scanTime, uint32_t processTime);
+void CountTelemetryTransition(uint8_t fromState, uint8_t toState);
+void SetTelemetryOverrun(uint32_t overrunCount, uint32_t maxLateness);
+#endif
+
+#endif /* SOURCE_USER_TELEMETRY_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,200 @@
+/*******************************************************************************
+ * File Name:   user_trace.c
+ *
+ * Description: This file contains the sensor trace capture. It stores the
+ *              sensor data of every frame in a ring buffer, as the change
+ *              since the previous frame with periodic key frames.
+ *
+ *******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+ ******************************************************************************/
+
+#include <string.h>
+#include "cycfg_capsense.h"
+#include "user_trace.h"
+
+#if ENABLE_TRACE_CAPTURE
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Range of a value change stored in a delta slot */
+#define TRACE_DELTA_MIN             (-128)
+#define TRACE_DELTA_MAX             (127)
+
+/* Sensor status bits stored in the slot header, touch and proximity */
+#define TRACE_STATUS_MSK            (0x03u)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void WriteTraceSlot(uint32_t type, uint32_t status, const uint16_t * data);
+
+/*******************************************************************************
+* Global Definitions
+*******************************************************************************/
+/* Trace data, placed in the host interface */
+static traceData_t * traceData = NULL;
+
+/* Values of the previous frame, the base of the next delta slot */
+static uint16_t lastValue[TRACE_VALUE_NUM];
+
+/* Frames since the last key frame, starts due to capture a key frame */
+static uint32_t keyFrameCount = TRACE_KEY_INTERVAL;
+
+static uint32_t frameNumber = 0u;
+
+/*******************************************************************************
+* Function Name: InitTrace
+********************************************************************************
+* Summary:
+* Sets and clears the trace data. The first frame captured is a key frame.
+*
+* Parameters:
+* data - pointer to the trace data
+*
+*******************************************************************************/
+void InitTrace(traceData_t * data)
+{
+    memset(data, 0, sizeof(*data));
+
+    data->version = TRACE_DATA_VERSION;
+    data->slotSize = (uint8_t)sizeof(traceSlot_t);
+    data->slotNum = TRACE_SLOT_NUM;
+    data->keyInterval = TRACE_KEY_INTERVAL;
+
+    keyFrameCount = TRACE_KEY_INTERVAL;
+    traceData = data;
+}
+
+/*******************************************************************************
+* Function Name: CaptureTrace
+********************************************************************************
+* Summary:
+* Captures the sensor data of the current frame. Called once per frame. A
+* delta slot is written when every value changed by less than a signed byte
+* since the previous frame, otherwise and every TRACE_KEY_INTERVAL frames a
+* key frame of two slots with the absolute values is written.
+*
+* Parameters:
+* appState - current application state
+*
+*******************************************************************************/
+void CaptureTrace(uint8_t appState)
+{
+    const cy_stc_capsense_sensor_context_t * prox = &cy_capsense_tuner.sensorContext[CY_CAPSENSE_PROXIMITY0_SNS0_ID];
+    const cy_stc_capsense_sensor_context_t * lp = &cy_capsense_tuner.sensorContext[CY_CAPSENSE_LOWPOWER0_SNS0_ID];
+    uint16_t value[TRACE_VALUE_NUM];
+    uint16_t delta[TRACE_VALUE_NUM / 2u];
+    bool isKeyFrame;
+    uint32_t status;
+    uint32_t i;
+
+    if (NULL == traceData)
+    {
+        return;
+    }
+
+    value[0u] = prox->raw;
+    value[1u] = prox->bsln;
+    value[2u] = prox->diff;
+    value[3u] = lp->raw;
+    value[4u] = lp->bsln;
+    value[5u] = lp->diff;
+
+    status = (((uint32_t)appState << TRACE_HEADER_STATE_POS) & TRACE_HEADER_STATE_MSK) |
+             (((uint32_t)(prox->status & TRACE_STATUS_MSK) << TRACE_HEADER_PROX_POS) & TRACE_HEADER_PROX_MSK) |
+             (((uint32_t)(lp->status & TRACE_STATUS_MSK) << TRACE_HEADER_LP_POS) & TRACE_HEADER_LP_MSK) |
+             (frameNumber & TRACE_HEADER_FRAME_MSK);
+
+    keyFrameCount++;
+    isKeyFrame = (TRACE_KEY_INTERVAL <= keyFrameCount);
+
+    for (i = 0u; (i < TRACE_VALUE_NUM) && (!isKeyFrame); i++)
+    {
+        int32_t change = (int32_t)value[i] - (int32_t)lastValue[i];
+
+        if ((TRACE_DELTA_MIN > change) || (TRACE_DELTA_MAX < change))
+        {
+            isKeyFrame = true;
+        }
+        else if (0u == (i & 1u))
+        {
+            delta[i / 2u] = (uint16_t)(((uint32_t)change & 0xFFu) << 8u);
+        }
+        else
+        {
+            delta[i / 2u] |= (uint16_t)((uint32_t)change & 0xFFu);
+        }
+    }
+
+    if (isKeyFrame)
+    {
+        WriteTraceSlot(TRACE_SLOT_KEY, status, &value[0u]);
+        WriteTraceSlot(TRACE_SLOT_KEY_LP, status, &value[TRACE_VALUE_NUM / 2u]);
+        keyFrameCount = 0u;
+    }
+    else
+    {
+        WriteTraceSlot(TRACE_SLOT_DELTA, status, delta);
+    }
+
+    memcpy(lastValue, value, sizeof(lastValue));
+    frameNumber++;
+}
+
+/*******************************************************************************
+* Function Name: WriteTraceSlot
+********************************************************************************
+* Summary:
+* Writes the next slot of the ring buffer and publishes it to the host by
+* incrementing slotCount.
+*
+* Parameters:
+* type - slot type, TRACE_SLOT_DELTA, TRACE_SLOT_KEY or TRACE_SLOT_KEY_LP
+* status - slot header without the slot type
+* data - TRACE_VALUE_NUM / 2 slot data words
+*
+*******************************************************************************/
+static void WriteTraceSlot(uint32_t type, uint32_t status, const uint16_t * data)
+{
+    traceSlot_t * slot = &traceData->slot[traceData->slotCount & (TRACE_SLOT_NUM - 1u)];
+
+    slot->header = (uint16_t)(((type << TRACE_HEADER_TYPE_POS) & TRACE_HEADER_TYPE_MSK) | status);
+    memcpy(slot->data, data, sizeof(slot->data));
+
+    traceData->slotCount++;
+}
+
+#endif /* ENABLE_TRACE_CAPTURE */
+
+/* [] END OF FILE */
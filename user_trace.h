@@ -0,0 +1,131 @@
+/******************************************************************************
+* File Name: user_trace.h
+*
+* Description: This file contains the macros, data types and function
+*              prototypes of the sensor trace capture.
+*
+*******************************************************************************
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_USER_TRACE_H_
+#define SOURCE_USER_TRACE_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* User configurable Macros
+*******************************************************************************/
+/* Enable this, to capture the raw count, baseline, diff and status of the
+* proximity and low power sensors and the application state of every frame in
+* a RAM ring buffer, read in bulk by the host on the EZI2C secondary slave
+* address for offline replay */
+#ifndef ENABLE_TRACE_CAPTURE
+#define ENABLE_TRACE_CAPTURE        (0u)
+#endif
+
+/* Number of slots of the ring buffer, 8 bytes each. A frame takes one slot,
+* or two slots for a key frame */
+#define TRACE_SLOT_NUM              (128u)
+
+/* A key frame with the absolute values is captured at least every
+* TRACE_KEY_INTERVAL frames, so the host can decode the ring buffer from any
+* slot after the writer wrapped */
+#define TRACE_KEY_INTERVAL          (32u)
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Layout version of traceData_t, incremented on every layout change */
+#define TRACE_DATA_VERSION          (1u)
+
+/* Slot header: slot type, application state, sensor status and frame number */
+#define TRACE_HEADER_TYPE_POS       (14u)
+#define TRACE_HEADER_TYPE_MSK       (0xC000u)
+#define TRACE_HEADER_STATE_POS      (11u)
+#define TRACE_HEADER_STATE_MSK      (0x3800u)
+#define TRACE_HEADER_PROX_POS       (9u)
+#define TRACE_HEADER_PROX_MSK       (0x0600u)
+#define TRACE_HEADER_LP_POS         (7u)
+#define TRACE_HEADER_LP_MSK         (0x0180u)
+#define TRACE_HEADER_FRAME_MSK      (0x007Fu)
+
+/* Slot types:
+* TRACE_SLOT_DELTA   - data holds the change of each value since the previous
+*                      frame, two signed bytes per word, the first one in the
+*                      high byte
+* TRACE_SLOT_KEY     - data holds the proximity raw count, baseline and diff,
+*                      followed by a TRACE_SLOT_KEY_LP slot of the same frame
+* TRACE_SLOT_KEY_LP  - data holds the low power raw count, baseline and diff */
+#define TRACE_SLOT_DELTA            (0u)
+#define TRACE_SLOT_KEY              (1u)
+#define TRACE_SLOT_KEY_LP           (2u)
+
+/* Values captured per frame: raw count, baseline and diff of each sensor */
+#define TRACE_VALUE_NUM             (6u)
+
+#if (0u != (TRACE_SLOT_NUM & (TRACE_SLOT_NUM - 1u)))
+    #error "TRACE_SLOT_NUM must be a power of two"
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+typedef struct traceSlot
+{
+    uint16_t header;
+    uint16_t data[TRACE_VALUE_NUM / 2u];
+} traceSlot_t;
+
+/* Trace ring buffer, exposed in the host interface on the EZI2C secondary
+* slave address. slotCount is incremented after each slot is written, the
+* slot written next is slot[slotCount % TRACE_SLOT_NUM]. The host reads
+* slotCount before and after reading the slots and drops the slots that were
+* overwritten meanwhile */
+typedef struct traceData
+{
+    uint8_t version;            /* TRACE_DATA_VERSION */
+    uint8_t slotSize;           /* sizeof(traceSlot_t) */
+    uint16_t slotNum;           /* TRACE_SLOT_NUM */
+    uint16_t slotCount;         /* Slots written, wraps */
+    uint16_t keyInterval;       /* TRACE_KEY_INTERVAL */
+    traceSlot_t slot[TRACE_SLOT_NUM];
+} traceData_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void InitTrace(traceData_t *);
+void CaptureTrace(uint8_t);
+
+#endif /* SOURCE_USER_TRACE_H_ */
+
+/* [] END OF FILE */